@@ -23,6 +23,10 @@
 #include <gatb/system/impl/System.hpp>
 
 #include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 using namespace std;
 using namespace gatb::core::system;
@@ -37,6 +41,8 @@ namespace gatb {  namespace core {  namespace bank {  namespace impl {
 
 static u_int64_t BINREADS_BUFFER = 100000;
 
+static bool BINREADS_MMAP = false;
+
 /********************************************************************************/
 
 static u_int64_t MAGIC_NUMBER = 0x12345678;  // set to 0 for no usage of magic number
@@ -101,7 +107,8 @@ unsigned char  code_n_NT(const char *seq, int nb)
 ** REMARKS :
 *********************************************************************/
 BankBinary::BankBinary (const std::string& filename, size_t nbValidLetters)
-    : _filename(filename), _nbValidLetters(nbValidLetters), binary_read_file(0)
+    : _filename(filename), _nbValidLetters(nbValidLetters), binary_read_file(0),
+      _mapAddress(0), _mapSize(0), _mapNbSequences(0), _mapTotalSize(0), _mapMaxSize(0)
 {
     read_write_buffer_size = BINREADS_BUFFER;
 
@@ -122,6 +129,8 @@ BankBinary::BankBinary (const std::string& filename, size_t nbValidLetters)
 *********************************************************************/
 BankBinary::~BankBinary ()
 {
+    unmap ();
+
     if(buffer!=NULL)
     {
         FREE (buffer); //buffer =NULL;
@@ -254,6 +263,9 @@ void BankBinary::flush ()
 
         fclose(binary_read_file);
         binary_read_file = 0;
+
+        /** The file has changed, so a previous mapping is no more valid. */
+        unmap ();
     }
 }
 
@@ -267,6 +279,9 @@ void BankBinary::flush ()
 *********************************************************************/
 void BankBinary::open (bool write)
 {
+    /** We won't be able to use a previous mapping if the file is written. */
+    if (write == true)  {  unmap ();  }
+
     binary_read_file = fopen (_filename.c_str(), write?"wb":"rb");
     if( binary_read_file == NULL)
     {
@@ -300,6 +315,16 @@ u_int64_t BankBinary::getSize ()
 *********************************************************************/
 void BankBinary::estimate (u_int64_t& number, u_int64_t& totalSize, u_int64_t& maxSize)
 {
+    /** With a mapped file, the information is known exactly from the blocks index. */
+    if (BINREADS_MMAP)
+    {
+        map ();
+        number    = _mapNbSequences;
+        totalSize = _mapTotalSize;
+        maxSize   = _mapMaxSize;
+        return;
+    }
+
     /** We create an iterator for the bank. */
     BankBinary::Iterator it (*this);
 
@@ -317,6 +342,8 @@ void BankBinary::estimate (u_int64_t& number, u_int64_t& totalSize, u_int64_t& m
 *********************************************************************/
 void BankBinary::remove ()
 {
+    unmap ();
+
     System::file().remove (_filename);
 }
 
@@ -333,6 +360,202 @@ void  BankBinary::setBufferSize (u_int64_t bufferSize)
     BINREADS_BUFFER = bufferSize;
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void  BankBinary::setMemoryMapped (bool mapped)
+{
+    BINREADS_MMAP = mapped;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+bool  BankBinary::isMemoryMapped ()
+{
+    return BINREADS_MMAP;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+tools::dp::Iterator<Sequence>* BankBinary::iterator ()
+{
+    if (BINREADS_MMAP)  {  return new MappedIterator (*this);  }
+    else                {  return new Iterator       (*this);  }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+tools::dp::Iterator<Sequence>* BankBinary::iterator (size_t firstBlock, size_t nbBlocks)
+{
+    return new MappedIterator (*this, firstBlock, nbBlocks);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+size_t BankBinary::getNbBlocks ()
+{
+    map ();
+    return _blocks.size();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the number of sequences is known only if the file is mapped
+*********************************************************************/
+int64_t BankBinary::getNbItems ()
+{
+    if (BINREADS_MMAP)  {  map ();  return _mapNbSequences;  }
+    return -1;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE : map the file in memory and build the index of its blocks
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : nothing is done if the file is already mapped
+*********************************************************************/
+void BankBinary::map ()
+{
+    if (_mapAddress != 0)  { return; }
+
+    /** We open the file. */
+    int fd = ::open (_filename.c_str(), O_RDONLY);
+    if (fd < 0)  {  throw gatb::core::system::ExceptionErrno (STR_BANK_unable_open_file, _filename.c_str());  }
+
+    struct stat st;
+    if (fstat (fd, &st) != 0)
+    {
+        ::close (fd);
+        throw gatb::core::system::ExceptionErrno (STR_BANK_unable_open_file, _filename.c_str());
+    }
+
+    size_t headerSize = MAGIC_NUMBER != 0 ? sizeof(MAGIC_NUMBER) : 0;
+
+    /** We check that the file can hold the magic number. */
+    if ((size_t)st.st_size < headerSize || st.st_size == 0)
+    {
+        ::close (fd);
+        if (headerSize > 0)  {  throw gatb::core::system::ExceptionErrno (STR_BANK_unable_open_file, _filename.c_str());  }
+        _blocks.clear();  _mapNbSequences = _mapTotalSize = _mapMaxSize = 0;
+        return;
+    }
+
+    /** We map the file; the descriptor is not needed any more once the mapping is done. */
+    void* addr = mmap (0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close (fd);
+
+    if (addr == MAP_FAILED)  {  throw gatb::core::system::ExceptionErrno (STR_BANK_unable_open_file, _filename.c_str());  }
+
+    /** The file is likely to be read from the beginning to the end. */
+    madvise (addr, st.st_size, MADV_SEQUENTIAL);
+
+    _mapAddress = (char*) addr;
+    _mapSize    = st.st_size;
+
+    /** We check the magic number. */
+    if (MAGIC_NUMBER != 0 && memcmp (_mapAddress, &MAGIC_NUMBER, sizeof(MAGIC_NUMBER)) != 0)
+    {
+        unmap ();
+        throw gatb::core::system::ExceptionErrno (STR_BANK_unable_open_file, _filename.c_str());
+    }
+
+    /** We build the blocks index. We have to go through the length of each sequence in order
+     * to know the index of the first sequence of each block. */
+    _blocks.clear();
+    _mapNbSequences = _mapTotalSize = _mapMaxSize = 0;
+
+    const char* loop = _mapAddress + headerSize;
+    const char* end  = _mapAddress + _mapSize;
+
+    while (loop + sizeof(unsigned int) <= end)
+    {
+        unsigned int block_size = 0;
+        memcpy (&block_size, loop, sizeof(unsigned int));
+        loop += sizeof(unsigned int);
+
+        /** We ignore a truncated block. */
+        if (loop + block_size > end)  { break; }
+
+        Block block;
+        block.offset     = loop - _mapAddress;
+        block.size       = block_size;
+        block.firstIndex = _mapNbSequences;
+        _blocks.push_back (block);
+
+        for (const char* seq = loop; seq + sizeof(int) <= loop + block_size; )
+        {
+            int readlen = 0;
+            memcpy (&readlen, seq, sizeof(int));
+
+            seq += sizeof(int) + (readlen+3)/4;
+
+            _mapNbSequences ++;
+            _mapTotalSize   += readlen;
+            if (readlen > (int)_mapMaxSize)  { _mapMaxSize = readlen; }
+        }
+
+        loop += block_size;
+    }
+
+    DEBUG (("BankBinary::map  '%s'  size=%lld  nbBlocks=%ld  nbSeq=%lld\n",
+        _filename.c_str(), _mapSize, _blocks.size(), _mapNbSequences
+    ));
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BankBinary::unmap ()
+{
+    if (_mapAddress != 0)
+    {
+        munmap (_mapAddress, _mapSize);
+        _mapAddress = 0;
+        _mapSize    = 0;
+        _blocks.clear();
+    }
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -560,6 +783,102 @@ void  BankBinary::Iterator::estimate (u_int64_t& number, u_int64_t& totalSize, u
     }  /* end of if (file != 0) */
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+BankBinary::MappedIterator::MappedIterator (BankBinary& ref, size_t firstBlock, size_t nbBlocks)
+    : _ref(ref), _isDone(true), _firstBlock(firstBlock), _nbBlocks(nbBlocks), _endBlock(0),
+      _block(0), _current(0), _end(0), _index(0)
+{
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+BankBinary::MappedIterator::~MappedIterator ()
+{
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BankBinary::MappedIterator::first()
+{
+    /** We map the file at first call. */
+    _ref.map ();
+
+    size_t nbBlocks = _ref._blocks.size();
+
+    /** We compute the range of iterated blocks. */
+    _endBlock = _nbBlocks < nbBlocks - std::min (_firstBlock, nbBlocks) ? _firstBlock + _nbBlocks : nbBlocks;
+
+    _isDone  = _firstBlock >= _endBlock;
+    _current = _end = 0;
+
+    if (_isDone)  { return; }
+
+    /** We go to the first block of the range. */
+    const Block& block = _ref._blocks[_firstBlock];
+    _block   = _firstBlock;
+    _current = _ref._mapAddress + block.offset;
+    _end     = _current + block.size;
+    _index   = block.firstIndex;
+
+    /** We go to the next sequence. */
+    next();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BankBinary::MappedIterator::next ()
+{
+    /** We may have to go to the next block. */
+    while (_current >= _end)
+    {
+        if (++_block >= _endBlock)  {  _isDone = true;  return;  }
+
+        const Block& block = _ref._blocks[_block];
+        _current = _ref._mapAddress + block.offset;
+        _end     = _current + block.size;
+    }
+
+    int len = 0;
+    memcpy (&len, _current, sizeof(int));
+    _current += sizeof(int);
+
+    /** The sequence data refers directly to the mapped nucleotides.
+     * NOTE: we keep the original size of the data, not the compressed one. */
+    _item->getData().setRef ((char*)_current, len);
+    _item->getData().setEncoding (tools::misc::Data::BINARY);
+
+    /** We set the sequence index. */
+    _item->setIndex (_index++);
+
+    /** We go ahead in the mapping. */
+    _current += (len+3)/4;
+}
+
 /********************************************************************************/
 } } } } /* end of namespaces. */
 /********************************************************************************/
@@ -62,6 +62,10 @@ namespace impl      {
  * In the following example, we can see how to convert any kind of bank into a binary bank:
  * \snippet bank8.cpp  snippet8_binary
  *
+ * The bank can also be read through a memory mapping of the file (see setMemoryMapped). In
+ * this mode, the iterated sequences refer directly to the mapped nucleotides (no copy is done)
+ * and an index of the blocks of the file is built once per bank, which allows to iterate
+ * disjoint ranges of blocks in different threads without any shared lock (see getNbBlocks).
  */
 class BankBinary : public AbstractBank
 {
@@ -86,10 +90,21 @@ public:
     std::string getId ()  { return _filename; }
 
     /** \copydoc IBank::iterator */
-    tools::dp::Iterator<Sequence>* iterator ()  { return new Iterator (*this); }
+    tools::dp::Iterator<Sequence>* iterator ();
+
+    /** Get an iterator on a range of blocks of the bank, the file being memory mapped.
+     * Iterators on disjoint ranges can be used concurrently by several threads.
+     * \param[in] firstBlock : index of the first block to be iterated
+     * \param[in] nbBlocks : number of blocks to be iterated
+     * \return the iterator. */
+    tools::dp::Iterator<Sequence>* iterator (size_t firstBlock, size_t nbBlocks);
+
+    /** Get the number of blocks of the bank. Note that the file is memory mapped by this call.
+     * \return the number of blocks. */
+    size_t getNbBlocks ();
 
     /** \copydoc IBank::getNbItems */
-    int64_t getNbItems () { return -1; }
+    int64_t getNbItems ();
 
     /** \copydoc IBank::insert */
     void insert (const Sequence& item);
@@ -111,6 +126,15 @@ public:
       */
     static void setBufferSize (u_int64_t bufferSize);
 
+    /** Tells whether the binary banks are read through a memory mapping (static method).
+      * \param[in] mapped : true for mapping the files, false for reading them with buffered I/O.
+      */
+    static void setMemoryMapped (bool mapped);
+
+    /** Tells whether the binary banks are read through a memory mapping (static method).
+      * \return true if the files are mapped. */
+    static bool isMemoryMapped ();
+
     /** Check that the given uri is a correct binary bank. */
     static bool check (const std::string& uri);
 
@@ -169,6 +193,59 @@ public:
         size_t _index;
     };
 
+    /************************************************************/
+
+    /** \brief Iterator on a memory mapped BankBinary
+     *
+     * The data of the iterated sequences refers directly to the mapping of the file, so
+     * it is valid as long as the bank is not modified nor deleted.
+     */
+    class MappedIterator : public tools::dp::Iterator<Sequence>
+    {
+    public:
+        /** Constructor.
+         * \param[in] ref : the associated iterable instance.
+         * \param[in] firstBlock : index of the first block to be iterated
+         * \param[in] nbBlocks : number of blocks to be iterated (default is up to the last block)
+         */
+        MappedIterator (BankBinary& ref, size_t firstBlock=0, size_t nbBlocks=~((size_t)0));
+
+        /** Destructor */
+        virtual ~MappedIterator ();
+
+        /** \copydoc tools::dp::Iterator::first */
+        void first();
+
+        /** \copydoc tools::dp::Iterator::next */
+        void next();
+
+        /** \copydoc tools::dp::Iterator::isDone */
+        bool isDone ()  { return _isDone; }
+
+        /** \copydoc tools::dp::Iterator::item */
+        Sequence& item ()  { return *_item; }
+
+    private:
+
+        /** Reference to the underlying Iterable instance. */
+        BankBinary&    _ref;
+
+        /** Tells whether the iteration is finished or not. */
+        bool _isDone;
+
+        /** Range of iterated blocks. */
+        size_t _firstBlock;
+        size_t _nbBlocks;
+        size_t _endBlock;
+
+        /** Current block and location of the next sequence in the mapping. */
+        size_t      _block;
+        const char* _current;
+        const char* _end;
+
+        size_t _index;
+    };
+
 protected:
 
     /** URI of the bank. */
@@ -183,6 +260,24 @@ protected:
 
     void open  (bool write);
     void close ();
+
+    /** Block of sequences in the memory mapped file. */
+    struct Block
+    {
+        u_int64_t offset;      // location of the sequences in the file
+        u_int64_t size;        // size of the block in bytes
+        u_int64_t firstIndex;  // index of the first sequence of the block
+    };
+
+    char*              _mapAddress;
+    u_int64_t          _mapSize;
+    std::vector<Block> _blocks;
+    u_int64_t          _mapNbSequences;
+    u_int64_t          _mapTotalSize;
+    u_int64_t          _mapMaxSize;
+
+    void map   ();
+    void unmap ();
 };
 
 /********************************************************************************/
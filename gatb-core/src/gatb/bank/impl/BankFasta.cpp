@@ -19,6 +19,7 @@
 
 #include <gatb/bank/impl/BankFasta.hpp>
 #include <gatb/bank/impl/BankComposite.hpp>
+#include <gatb/bank/impl/GzipReader.hpp>
 
 #include <gatb/system/impl/System.hpp>
 #include <gatb/tools/misc/api/StringsRepository.hpp>
@@ -26,6 +27,11 @@
 #include <gatb/tools/designpattern/impl/IteratorHelpers.hpp>
 
 #include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <map>
 #include <string.h>
 #include <errno.h>
 #include <zlib.h> // Added by Pierre Peterlongo on 02/08/2012.
@@ -52,11 +58,13 @@ namespace gatb {  namespace core {  namespace bank {  namespace impl {
 
 size_t BankFasta::_dataLineSize = 70;
 
+size_t BankFasta::_nbParserThreads = 0;
+
 /********************************************************************************/
 // heavily inspired by kseq.h from Heng Li (https://github.com/attractivechaos/klib)
 typedef struct
 {
-    gzFile stream;
+    GzipReader* stream;
     unsigned char *buffer;
     uint64_t buffer_start, buffer_end;
     bool eof;
@@ -64,7 +72,7 @@ typedef struct
 
     void rewind ()
     {
-        gzrewind (stream);
+        stream->rewind ();
         last_char    = 0;
         eof          = 0;
         buffer_start = 0;
@@ -205,6 +213,20 @@ void BankFasta::estimate (u_int64_t& number, u_int64_t& totalSize, u_int64_t& ma
     it.estimate (number, totalSize, maxSize);
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+tools::dp::Iterator<Sequence>* BankFasta::iterator ()
+{
+    if (_nbParserThreads > 0)  { return new ParallelIterator (*this, _nbParserThreads); }
+    else                       { return new Iterator (*this);                          }
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -392,7 +414,9 @@ inline bool rebuffer (buffered_file_t *bf)
 {
     if (bf->eof) return false;
     bf->buffer_start = 0;
-    bf->buffer_end = gzread (bf->stream, bf->buffer, BUFFER_SIZE);
+    int nbRead = bf->stream->read (bf->buffer, BUFFER_SIZE);
+    if (nbRead < 0)  { throw gatb::core::system::Exception ("unable to read data (corrupted compressed file ?)"); }
+    bf->buffer_end = nbRead;
     if (bf->buffer_end < BUFFER_SIZE) bf->eof = 1;
     if (bf->buffer_end == 0) return false;
     return true;
@@ -650,10 +674,10 @@ void BankFasta::Iterator::init ()
         buffered_file_t** bf = (buffered_file_t **) buffered_file + i;
         *bf = (buffered_file_t *)  CALLOC (1, sizeof(buffered_file_t));
         (*bf)->buffer = (unsigned char*)  MALLOC (BUFFER_SIZE);
-        (*bf)->stream = gzopen (fname, "r");
+        (*bf)->stream = new GzipReader (fname);
 		
         /** We check that we can open the file. */
-        if ((*bf)->stream == NULL)
+        if ((*bf)->stream->isOpen() == false)
         {
             // there used to be some cleanup here but what's the point, we're going to throw an exception anyway
         
@@ -699,7 +723,7 @@ void BankFasta::Iterator::finalize ()
         if (bf != 0)
         {
             /** We close the handle of the file. */
-            if (bf->stream != NULL)  {  gzclose (bf->stream);  bf->stream = 0; }
+            if (bf->stream != NULL)  {  delete bf->stream;  bf->stream = 0; }
 
             /** We delete the buffer. */
             FREE (bf->buffer);
@@ -759,7 +783,7 @@ void BankFasta::Iterator::estimate (u_int64_t& number, u_int64_t& totalSize, u_i
     {
         buffered_file_t* current = (buffered_file_t *) buffered_file[i];
 
-        actualPosition += gztell (current->stream);
+        actualPosition += current->stream->tell ();
     }
 
     if (actualPosition > 0)
@@ -770,6 +794,409 @@ void BankFasta::Iterator::estimate (u_int64_t& number, u_int64_t& totalSize, u_i
     }
 }
 
+/********************************************************************************/
+/*                               PARALLEL PARSING                               */
+/********************************************************************************/
+
+#define PARSE_CHUNK_SIZE  (4*1024*1024)
+
+/** Offsets (in the text of the chunk) of the parts of one parsed record. */
+struct parsed_record_t
+{
+    size_t header_offset,  header_length;
+    size_t data_offset,    data_length;
+    size_t quality_offset, quality_length;
+};
+
+/** Chunk of the file holding only complete records. The records are parsed in place,
+ * ie. the nucleotides and quality lines are compacted in the text buffer itself. */
+struct parse_chunk_t
+{
+    u_int64_t                    rank;
+    vector<char>                 text;
+    vector<parsed_record_t>      records;
+};
+
+/********************************************************************************/
+struct parse_pipeline_t
+{
+    parse_pipeline_t (const string& filename, size_t nbThreads, BankFasta::Iterator::CommentMode_e mode)
+        : filename(filename), mode(mode), maxInflight(2*nbThreads+2), inflight(0),
+          nbChunks(0), readerDone(false), stop(false), error(false)
+    {
+        threads.push_back (std::thread (&parse_pipeline_t::reader, this));
+        for (size_t i=0; i<nbThreads; i++)  {  threads.push_back (std::thread (&parse_pipeline_t::parser, this));  }
+    }
+
+    ~parse_pipeline_t ()
+    {
+        {
+            std::unique_lock<std::mutex> lock (mutex);
+            stop = true;
+        }
+        cond.notify_all();
+
+        for (size_t i=0; i<threads.size(); i++)  { threads[i].join(); }
+
+        for (size_t i=0; i<todo.size(); i++)  { delete todo[i]; }
+        for (map<u_int64_t,parse_chunk_t*>::iterator it = done.begin(); it != done.end(); ++it)  { delete it->second; }
+    }
+
+    /** Wait for the parsed chunk of the given rank; returns 0 when there is no more chunk. */
+    parse_chunk_t* get (u_int64_t rank)
+    {
+        std::unique_lock<std::mutex> lock (mutex);
+
+        map<u_int64_t,parse_chunk_t*>::iterator it;
+        while ((it = done.find(rank)) == done.end())
+        {
+            if (error)  { throw gatb::core::system::Exception ("unable to read file %s", filename.c_str()); }
+            if (readerDone && rank >= nbChunks)  { return 0; }
+            cond.wait (lock);
+        }
+
+        parse_chunk_t* result = it->second;
+        done.erase (it);
+        return result;
+    }
+
+    /** Release a chunk previously got through 'get'. */
+    void release (parse_chunk_t* chunk)
+    {
+        delete chunk;
+        {
+            std::unique_lock<std::mutex> lock (mutex);
+            inflight--;
+        }
+        cond.notify_all();
+    }
+
+    /** Main loop of the thread reading the file. */
+    void reader ()
+    {
+        GzipReader stream (filename);
+        if (stream.isOpen() == false)
+        {
+            std::unique_lock<std::mutex> lock (mutex);
+            error = readerDone = true;
+            cond.notify_all();
+            return;
+        }
+
+        vector<char> pending;
+        bool isFastq = false;
+        bool formatKnown = false;
+        bool eof = false;
+        u_int64_t rank = 0;
+
+        while (!eof)
+        {
+            /** We wait until the number of chunks in the pipeline allows to read a new one. */
+            {
+                std::unique_lock<std::mutex> lock (mutex);
+                while (!stop && inflight >= maxInflight)  { cond.wait (lock); }
+                if (stop)  { break; }
+            }
+
+            /** We append a new block of the file to the pending bytes. */
+            size_t previous = pending.size();
+            pending.resize (previous + PARSE_CHUNK_SIZE);
+            int nbRead = stream.read (pending.data() + previous, PARSE_CHUNK_SIZE);
+            if (nbRead < 0)
+            {
+                std::unique_lock<std::mutex> lock (mutex);
+                error = true;
+                break;
+            }
+            pending.resize (previous + nbRead);
+            eof = nbRead < PARSE_CHUNK_SIZE;
+
+            if (!formatKnown)
+            {
+                for (size_t i=0; i<pending.size(); i++)
+                {
+                    if (!isspace(pending[i]))  { isFastq = pending[i]=='@';  formatKnown = true;  break; }
+                }
+            }
+
+            /** We look for the beginning of the last record of the pending bytes. */
+            size_t cut = eof ? pending.size() : findLastRecord (pending, isFastq);
+            if (cut == 0)  { continue; }
+
+            parse_chunk_t* chunk = new parse_chunk_t;
+            chunk->rank = rank++;
+            chunk->text.assign (pending.begin(), pending.begin() + cut);
+            pending.erase (pending.begin(), pending.begin() + cut);
+
+            {
+                std::unique_lock<std::mutex> lock (mutex);
+                todo.push_back (chunk);
+                inflight++;
+            }
+            cond.notify_all();
+        }
+
+        {
+            std::unique_lock<std::mutex> lock (mutex);
+            nbChunks   = rank;
+            readerDone = true;
+        }
+        cond.notify_all();
+    }
+
+    /** Main loop of the parser threads. */
+    void parser ()
+    {
+        while (true)
+        {
+            parse_chunk_t* chunk = 0;
+            {
+                std::unique_lock<std::mutex> lock (mutex);
+                while (!stop && todo.empty() && !readerDone)  { cond.wait (lock); }
+                if (stop || todo.empty())  { break; }
+                chunk = todo.front();
+                todo.pop_front();
+            }
+
+            parse (chunk);
+
+            {
+                std::unique_lock<std::mutex> lock (mutex);
+                done[chunk->rank] = chunk;
+            }
+            cond.notify_all();
+        }
+    }
+
+    /** Get the offset of the beginning of the last record that starts a line in the buffer,
+     * 0 if not found. For FASTQ, a record start is a '@' line followed by a '+' line two lines
+     * later, since quality lines may also begin by a '@'. */
+    static size_t findLastRecord (const vector<char>& buf, bool isFastq)
+    {
+        size_t len = buf.size();
+
+        for (size_t p=len; p-- > 1; )
+        {
+            if (buf[p-1] != '\n')  { continue; }
+
+            if (!isFastq)
+            {
+                if (buf[p]=='>')  { return p; }
+            }
+            else if (buf[p]=='@')
+            {
+                const char* sep1 = (const char*) memchr (buf.data()+p, '\n', len-p);
+                if (sep1 == 0)  { continue; }
+                const char* sep2 = (const char*) memchr (sep1+1, '\n', buf.data()+len-sep1-1);
+                if (sep2 == 0)  { continue; }
+                if (sep2+1 < buf.data()+len && sep2[1]=='+')  { return p; }
+            }
+        }
+        return 0;
+    }
+
+    /** Get the end of the line starting at offset i (ie. offset of the '\n' or the text size). */
+    static size_t endOfLine (const char* buf, size_t i, size_t len)
+    {
+        const char* eol = (const char*) memchr (buf+i, '\n', len-i);
+        return eol ? eol-buf : len;
+    }
+
+    /** Parse the chunk; same rules as for BankFasta::Iterator::get_next_seq_from_file. */
+    void parse (parse_chunk_t* chunk)
+    {
+        char*  buf = chunk->text.data();
+        size_t len = chunk->text.size();
+        size_t i   = 0;
+
+        while (i < len)
+        {
+            /** We go to the next header. */
+            while (i < len && buf[i]!='>' && buf[i]!='@')  { i++; }
+            if (i >= len)  { break; }
+            i++;
+
+            parsed_record_t rec;
+
+            size_t eol = endOfLine (buf, i, len);
+            size_t end = (eol > i && buf[eol-1]=='\r') ? eol-1 : eol;
+
+            rec.header_offset = i;
+            rec.header_length = end - i;
+            if (mode == BankFasta::Iterator::IDONLY)
+            {
+                size_t j=i;
+                while (j<end && !isspace(buf[j]))  { j++; }
+                rec.header_length = j - i;
+            }
+            i = eol + 1;
+
+            /** We compact the nucleotides lines just after the header. */
+            size_t w = i;
+            rec.data_offset = w;
+            while (i < len && buf[i]!='>' && buf[i]!='+' && buf[i]!='@')
+            {
+                if (buf[i]=='\n')  { i++; continue; }
+                eol = endOfLine (buf, i, len);
+                end = (eol > i && buf[eol-1]=='\r') ? eol-1 : eol;
+                memmove (buf+w, buf+i, end-i);
+                w += end-i;
+                i = eol + 1;
+            }
+            rec.data_length = w - rec.data_offset;
+
+            /** We compact the quality lines just after the nucleotides. */
+            rec.quality_offset = w;
+            if (i < len && buf[i]=='+')
+            {
+                i = endOfLine (buf, i, len) + 1;
+                do
+                {
+                    if (i >= len)  { break; }
+                    eol = endOfLine (buf, i, len);
+                    end = (eol > i && buf[eol-1]=='\r') ? eol-1 : eol;
+                    memmove (buf+w, buf+i, end-i);
+                    w += end-i;
+                    i = eol + 1;
+                }
+                while (w - rec.quality_offset < rec.data_length);
+            }
+            rec.quality_length = w - rec.quality_offset;
+
+            chunk->records.push_back (rec);
+        }
+    }
+
+    string filename;
+    BankFasta::Iterator::CommentMode_e mode;
+
+    std::mutex              mutex;
+    std::condition_variable cond;
+
+    vector<std::thread>                 threads;
+    deque<parse_chunk_t*>               todo;
+    map<u_int64_t,parse_chunk_t*>       done;
+
+    size_t    maxInflight;
+    size_t    inflight;
+    u_int64_t nbChunks;
+    bool      readerDone;
+    bool      stop;
+    bool      error;
+};
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+BankFasta::ParallelIterator::ParallelIterator (BankFasta& ref, size_t nbThreads, BankFasta::Iterator::CommentMode_e commentMode)
+    : _ref(ref), _nbThreads(nbThreads), _commentsMode(commentMode), _isDone(true),
+      _pipeline(0), _chunk(0), _recordIdx(0), _index(0)
+{
+    if (_nbThreads == 0)  { _nbThreads = System::info().getNbCores(); }
+
+    /** We check that the file can be opened. */
+    if (gzFile stream = gzopen (_ref._filenames[0].c_str(), "r"))  {  gzclose (stream);  }
+    else  {
+        throw gatb::core::system::ExceptionErrno (STR_BANK_unable_open_file, _ref._filenames[0].c_str());  }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+BankFasta::ParallelIterator::~ParallelIterator ()
+{
+    finalize ();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BankFasta::ParallelIterator::first ()
+{
+    /** We restart the parsing pipeline from the beginning of the file. */
+    finalize ();
+
+    _pipeline  = new parse_pipeline_t (_ref._filenames[0], _nbThreads, _commentsMode);
+    _chunk     = 0;
+    _recordIdx = 0;
+    _index     = 0;
+    _isDone    = false;
+
+    next ();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BankFasta::ParallelIterator::next ()
+{
+    if (_isDone)  { return; }
+
+    parse_pipeline_t* pipeline = (parse_pipeline_t*) _pipeline;
+    parse_chunk_t*    chunk    = (parse_chunk_t*)    _chunk;
+
+    /** We may have to go to the next non empty chunk. */
+    while (chunk == 0 || _recordIdx >= chunk->records.size())
+    {
+        u_int64_t rank = chunk ? chunk->rank+1 : 0;
+
+        if (chunk != 0)  { pipeline->release (chunk); }
+
+        _chunk = chunk = pipeline->get (rank);
+        _recordIdx = 0;
+
+        if (chunk == 0)  { _isDone = true;  return; }
+    }
+
+    const parsed_record_t& rec = chunk->records[_recordIdx++];
+    const char*            buf = chunk->text.data();
+
+    _item->getData().set ((char*)buf + rec.data_offset, rec.data_length);
+
+    if (_commentsMode != BankFasta::Iterator::NONE)
+    {
+        _item->_comment.assign (buf + rec.header_offset,  rec.header_length);
+        _item->_quality.assign (buf + rec.quality_offset, rec.quality_length);
+    }
+
+    _item->setIndex (_index++);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BankFasta::ParallelIterator::finalize ()
+{
+    if (_chunk != 0)     {  delete (parse_chunk_t*) _chunk;          _chunk    = 0; }
+    if (_pipeline != 0)  {  delete (parse_pipeline_t*) _pipeline;    _pipeline = 0; }
+    _isDone = true;
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
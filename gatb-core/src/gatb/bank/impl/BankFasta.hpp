@@ -82,8 +82,10 @@ public:
     /** \copydoc IBank::getId. */
     std::string getId ()  { return _filenames[0]; }
 
-    /** \copydoc IBank::iterator */
-    tools::dp::Iterator<Sequence>* iterator ()  { return new Iterator (*this); }
+    /** \copydoc IBank::iterator
+     * Note that a ParallelIterator is returned if a number of parser threads has been set
+     * through setNbParserThreads. */
+    tools::dp::Iterator<Sequence>* iterator ();
 
     /** \copydoc IBank::getNbItems */
     int64_t getNbItems () { return -1; }
@@ -103,6 +105,12 @@ public:
     static void setDataLineSize (size_t len) { _dataLineSize = len; }
     static size_t getDataLineSize ()  { return _dataLineSize; }
 
+    /** Set the number of threads used for parsing the file(s) of the bank when iterating it
+     * through the 'iterator' method. If 0 (default), the file is parsed in the calling thread.
+     * \param[in] nb : number of parser threads. */
+    static void setNbParserThreads (size_t nb) { _nbParserThreads = nb; }
+    static size_t getNbParserThreads ()  { return _nbParserThreads; }
+
     /** \copydoc IBank::finalize */
     void finalize ();
 
@@ -206,6 +214,70 @@ public:
         size_t _index;
     };
 
+    /************************************************************/
+
+    /** \brief Iterator parsing the bank with several threads
+     *
+     * One thread reads the file (through a GzipReader) by large chunks that are
+     * cut on record boundaries; N other threads parse these chunks into batches of records.
+     * The iterator then provides the parsed records in the same order as in the file, so
+     * a client (a Dispatcher for instance) only has to copy already parsed sequences.
+     *
+     * The FASTQ records are expected to be in the usual 4 lines format. Multi-lines FASTQ
+     * files are still supported but won't be split into several chunks.
+     *
+     * As for Iterator, the implementation type of the parsing pipeline is hidden in the cpp file.
+     */
+    class ParallelIterator : public tools::dp::Iterator<Sequence>
+    {
+    public:
+
+        /** Constructor.
+         * \param[in] ref : the associated iterable instance.
+         * \param[in] nbThreads : number of parser threads (0 means number of cores)
+         * \param[in] commentMode : kind of comments we want to retrieve
+         */
+        ParallelIterator (BankFasta& ref, size_t nbThreads=0, BankFasta::Iterator::CommentMode_e commentMode = BankFasta::Iterator::FULL);
+
+        /** Destructor */
+        ~ParallelIterator ();
+
+        /** \copydoc tools::dp::Iterator::first */
+        void first();
+
+        /** \copydoc tools::dp::Iterator::next */
+        void next();
+
+        /** \copydoc tools::dp::Iterator::isDone */
+        bool isDone ()  { return _isDone; }
+
+        /** \copydoc tools::dp::Iterator::item */
+        Sequence& item ()     { return *_item; }
+
+        /** \copydoc tools::dp::Iterator::finalize */
+        void finalize ();
+
+    private:
+
+        /** Reference to the underlying Iterable instance. */
+        BankFasta&    _ref;
+
+        /** Number of parser threads. */
+        size_t _nbThreads;
+
+        /** Tells what kind of comments we want as a client of the iterator. */
+        BankFasta::Iterator::CommentMode_e  _commentsMode;
+
+        /** Tells whether the iteration is finished or not. */
+        bool _isDone;
+
+        void* _pipeline;   // parse_pipeline_t
+        void* _chunk;      // parse_chunk_t currently iterated
+        size_t _recordIdx; // index of the next record in the current chunk
+
+        size_t _index;
+    };
+
 protected:
 
     /** \return maximum number of files. */
@@ -229,6 +301,8 @@ protected:
     
     static size_t _dataLineSize;
 
+    static size_t _nbParserThreads;
+
     /** Initialization method (compute the file sizes). */
     void init ();
 };
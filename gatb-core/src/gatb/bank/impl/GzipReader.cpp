@@ -0,0 +1,524 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include <gatb/bank/impl/GzipReader.hpp>
+
+#include <gatb/system/impl/System.hpp>
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <vector>
+#include <string.h>
+#include <stdio.h>
+#include <zlib.h>
+
+using namespace std;
+using namespace gatb::core::system;
+using namespace gatb::core::system::impl;
+
+#define DEBUG(a)  //printf a
+
+/** Size of the blocks inflated by the thread reading gzip files. */
+#define GZIP_BLOCK_SIZE  (1024*1024)
+
+/********************************************************************************/
+namespace gatb {  namespace core {  namespace bank {  namespace impl {
+/********************************************************************************/
+
+/** Block of uncompressed data; for BGZF files, also holds the compressed block. */
+struct inflated_block_t
+{
+    u_int64_t    rank;
+    vector<char> data;
+    vector<char> compressed;
+};
+
+/********************************************************************************/
+static inline u_int32_t le16 (const unsigned char* p)  { return p[0] | (p[1]<<8); }
+static inline u_int32_t le32 (const unsigned char* p)  { return p[0] | (p[1]<<8) | (p[2]<<16) | ((u_int32_t)p[3]<<24); }
+
+/** Read the header of a BGZF block (ie. a gzip member with a 'BC' extra subfield).
+ * \return the total size of the block, 0 if the header is not a BGZF one. */
+static size_t readBgzfHeader (FILE* file, vector<char>& header)
+{
+    header.resize (12);
+    if (fread (header.data(), 1, 12, file) != 12)  { return 0; }
+
+    const unsigned char* h = (const unsigned char*) header.data();
+    if (h[0]!=31 || h[1]!=139 || h[2]!=8 || (h[3] & 4)==0)  { return 0; }
+
+    size_t xlen = le16 (h+10);
+    header.resize (12 + xlen);
+    if (fread (header.data()+12, 1, xlen, file) != xlen)  { return 0; }
+
+    const unsigned char* extra = (const unsigned char*) header.data() + 12;
+    for (size_t i=0; i+4 <= xlen; )
+    {
+        size_t slen = le16 (extra+i+2);
+        if (extra[i]==66 && extra[i+1]==67 && slen==2 && i+6 <= xlen)  {  return le16 (extra+i+4) + 1;  }
+        i += 4 + slen;
+    }
+    return 0;
+}
+
+/********************************************************************************/
+struct inflate_pipeline_t
+{
+    inflate_pipeline_t (const string& filename, GzipReader::Kind_e kind, size_t nbThreads)
+        : filename(filename), maxInflight(4*(nbThreads+1)), inflight(0),
+          nbBlocks(0), readerDone(false), stop(false), error(false)
+    {
+        if (kind == GzipReader::BGZF)
+        {
+            threads.push_back (std::thread (&inflate_pipeline_t::readerBgzf, this));
+            for (size_t i=0; i<nbThreads; i++)  {  threads.push_back (std::thread (&inflate_pipeline_t::inflater, this));  }
+        }
+        else
+        {
+            threads.push_back (std::thread (&inflate_pipeline_t::readerGzip, this));
+        }
+    }
+
+    ~inflate_pipeline_t ()
+    {
+        {
+            std::unique_lock<std::mutex> lock (mutex);
+            stop = true;
+        }
+        cond.notify_all();
+
+        for (size_t i=0; i<threads.size(); i++)  { threads[i].join(); }
+
+        for (size_t i=0; i<todo.size(); i++)  { delete todo[i]; }
+        for (map<u_int64_t,inflated_block_t*>::iterator it = done.begin(); it != done.end(); ++it)  { delete it->second; }
+    }
+
+    /** Wait for the inflated block of the given rank; returns 0 when there is no more block
+     * or if an error occurred. */
+    inflated_block_t* get (u_int64_t rank, bool& hasError)
+    {
+        std::unique_lock<std::mutex> lock (mutex);
+
+        map<u_int64_t,inflated_block_t*>::iterator it;
+        while ((it = done.find(rank)) == done.end())
+        {
+            if (error)  { hasError = true;  return 0; }
+            if (readerDone && rank >= nbBlocks)  { return 0; }
+            cond.wait (lock);
+        }
+
+        inflated_block_t* result = it->second;
+        done.erase (it);
+        return result;
+    }
+
+    /** Release a block previously got through 'get'. */
+    void release (inflated_block_t* block)
+    {
+        delete block;
+        {
+            std::unique_lock<std::mutex> lock (mutex);
+            inflight--;
+        }
+        cond.notify_all();
+    }
+
+    /** Wait until the number of blocks in the pipeline allows to read a new one.
+     * \return false if the pipeline is stopped. */
+    bool waitSlot ()
+    {
+        std::unique_lock<std::mutex> lock (mutex);
+        while (!stop && inflight >= maxInflight)  { cond.wait (lock); }
+        return !stop;
+    }
+
+    /** Put a block in one of the pipeline queues. */
+    void push (inflated_block_t* block, bool inflated)
+    {
+        {
+            std::unique_lock<std::mutex> lock (mutex);
+            if (inflated)  { done[block->rank] = block; }
+            else           { todo.push_back (block);    }
+            inflight++;
+        }
+        cond.notify_all();
+    }
+
+    /** Tell that no more block will be read. */
+    void finish (u_int64_t nb, bool hasError)
+    {
+        {
+            std::unique_lock<std::mutex> lock (mutex);
+            nbBlocks   = nb;
+            readerDone = true;
+            error      = error || hasError;
+        }
+        cond.notify_all();
+    }
+
+    /** Main loop of the thread reading and inflating a gzip file. */
+    void readerGzip ()
+    {
+        u_int64_t rank     = 0;
+        bool      hasError = false;
+
+        gzFile stream = gzopen (filename.c_str(), "r");
+
+        if (stream == NULL)  { hasError = true; }
+        else
+        {
+            gzbuffer (stream, 1024*1024);
+
+            while (waitSlot())
+            {
+                inflated_block_t* block = new inflated_block_t;
+                block->data.resize (GZIP_BLOCK_SIZE);
+
+                int nbRead = gzread (stream, block->data.data(), GZIP_BLOCK_SIZE);
+                if (nbRead <= 0)
+                {
+                    /** Note that gzread doesn't return an error for a truncated file. */
+                    int errnum = Z_OK;
+                    gzerror (stream, &errnum);
+                    hasError = nbRead < 0 || errnum != Z_OK;
+                    delete block;
+                    break;
+                }
+
+                block->rank = rank++;
+                block->data.resize (nbRead);
+                push (block, true);
+            }
+
+            gzclose (stream);
+        }
+
+        finish (rank, hasError);
+    }
+
+    /** Main loop of the thread reading the compressed blocks of a BGZF file. */
+    void readerBgzf ()
+    {
+        u_int64_t rank     = 0;
+        bool      hasError = false;
+
+        FILE* file = fopen (filename.c_str(), "rb");
+
+        if (file == NULL)  { hasError = true; }
+        else
+        {
+            vector<char> header;
+
+            while (waitSlot())
+            {
+                /** We check whether we are at the end of the file. */
+                int c = fgetc (file);
+                if (c == EOF)  { break; }
+                ungetc (c, file);
+
+                size_t blockSize = readBgzfHeader (file, header);
+                if (blockSize == 0 || blockSize < header.size() + 8)  { hasError = true;  break; }
+
+                inflated_block_t* block = new inflated_block_t;
+                block->rank = rank++;
+                block->compressed.resize (blockSize - header.size());
+
+                if (fread (block->compressed.data(), 1, block->compressed.size(), file) != block->compressed.size())
+                {
+                    hasError = true;  delete block;  break;
+                }
+
+                push (block, false);
+            }
+
+            fclose (file);
+        }
+
+        finish (rank, hasError);
+    }
+
+    /** Main loop of the threads inflating BGZF blocks. */
+    void inflater ()
+    {
+        while (true)
+        {
+            inflated_block_t* block = 0;
+            {
+                std::unique_lock<std::mutex> lock (mutex);
+                while (!stop && todo.empty() && !readerDone)  { cond.wait (lock); }
+                if (stop || todo.empty())  { break; }
+                block = todo.front();
+                todo.pop_front();
+            }
+
+            bool ok = inflateBgzf (block);
+
+            {
+                std::unique_lock<std::mutex> lock (mutex);
+                done[block->rank] = block;
+                error = error || !ok;
+            }
+            cond.notify_all();
+        }
+    }
+
+    /** Inflate one BGZF block (raw deflate data followed by CRC32 and uncompressed size). */
+    static bool inflateBgzf (inflated_block_t* block)
+    {
+        size_t               len   = block->compressed.size();
+        const unsigned char* cdata = (const unsigned char*) block->compressed.data();
+
+        u_int32_t crc   = le32 (cdata + len - 8);
+        u_int32_t isize = le32 (cdata + len - 4);
+
+        block->data.resize (isize);
+
+        z_stream zs;
+        memset (&zs, 0, sizeof(zs));
+        if (inflateInit2 (&zs, -15) != Z_OK)  { return false; }
+
+        /** Note: zlib refuses a null output buffer, which may happen for the empty EOF block. */
+        Bytef dummy;
+
+        zs.next_in   = (Bytef*) cdata;
+        zs.avail_in  = len - 8;
+        zs.next_out  = isize > 0 ? (Bytef*) block->data.data() : &dummy;
+        zs.avail_out = isize;
+
+        int res = inflate (&zs, Z_FINISH);
+        bool ok = (res == Z_STREAM_END) && (zs.total_out == isize);
+        inflateEnd (&zs);
+
+        if (ok)  {  ok = crc32 (crc32(0L, Z_NULL, 0), (const Bytef*) block->data.data(), isize) == crc;  }
+
+        /** We don't need the compressed data anymore. */
+        vector<char>().swap (block->compressed);
+
+        return ok;
+    }
+
+    string filename;
+
+    std::mutex              mutex;
+    std::condition_variable cond;
+
+    vector<std::thread>                 threads;
+    deque<inflated_block_t*>            todo;
+    map<u_int64_t,inflated_block_t*>    done;
+
+    size_t    maxInflight;
+    size_t    inflight;
+    u_int64_t nbBlocks;
+    bool      readerDone;
+    bool      stop;
+    bool      error;
+};
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+static int detectKind (const string& filename)
+{
+    FILE* file = fopen (filename.c_str(), "rb");
+    if (file == NULL)  { return -1; }
+
+    int result = GzipReader::UNCOMPRESSED;
+
+    unsigned char magic[2];
+    if (fread (magic, 1, 2, file) == 2 && magic[0]==31 && magic[1]==139)
+    {
+        vector<char> header;
+        rewind (file);
+        result = readBgzfHeader (file, header) > 0 ? GzipReader::BGZF : GzipReader::GZIP;
+    }
+
+    fclose (file);
+    return result;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+GzipReader::Kind_e GzipReader::getKind (const std::string& filename)
+{
+    int kind = detectKind (filename);
+    return kind < 0 ? UNCOMPRESSED : (Kind_e) kind;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+GzipReader::GzipReader (const std::string& filename, size_t nbThreads)
+    : _filename(filename), _nbThreads(nbThreads), _kind(KIND_UNKNOWN), _position(0),
+      _stream(0), _pipeline(0), _block(0), _blockIdx(0), _rank(0)
+{
+    if (_nbThreads == 0)  { _nbThreads = System::info().getNbCores(); }
+
+    _kind = detectKind (filename);
+
+    /** Uncompressed files are read directly in the calling thread. */
+    if (_kind == UNCOMPRESSED)
+    {
+        _stream = gzopen (filename.c_str(), "r");
+        if (_stream == 0)  { _kind = KIND_UNKNOWN; }
+    }
+
+    DEBUG (("GzipReader::GzipReader  file='%s'  kind=%d\n", filename.c_str(), _kind));
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+GzipReader::~GzipReader ()
+{
+    stop ();
+
+    if (_stream != 0)  { gzclose ((gzFile) _stream); }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void GzipReader::start ()
+{
+    if (_pipeline == 0)  {  _pipeline = new inflate_pipeline_t (_filename, (Kind_e)_kind, _nbThreads);  }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void GzipReader::stop ()
+{
+    if (_block    != 0)  {  delete (inflated_block_t*)   _block;     _block    = 0; }
+    if (_pipeline != 0)  {  delete (inflate_pipeline_t*) _pipeline;  _pipeline = 0; }
+    _blockIdx = 0;
+    _rank     = 0;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void GzipReader::rewind ()
+{
+    stop ();
+
+    if (_stream != 0)  { gzrewind ((gzFile) _stream); }
+
+    _position = 0;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+int GzipReader::read (void* buffer, size_t len)
+{
+    if (_kind == KIND_UNKNOWN)  { return -1; }
+
+    if (_kind == UNCOMPRESSED)
+    {
+        int nbRead = gzread ((gzFile) _stream, buffer, len);
+        if (nbRead > 0)  { _position += nbRead; }
+        return nbRead;
+    }
+
+    /** We may have to start the inflating threads. */
+    start ();
+
+    inflate_pipeline_t* pipeline = (inflate_pipeline_t*) _pipeline;
+
+    size_t total    = 0;
+    bool   hasError = false;
+
+    while (total < len)
+    {
+        inflated_block_t* block = (inflated_block_t*) _block;
+
+        /** We may have to go to the next block. */
+        if (block == 0 || _blockIdx >= block->data.size())
+        {
+            if (block != 0)  { pipeline->release (block);  _block = 0; }
+
+            _block    = block = pipeline->get (_rank, hasError);
+            _blockIdx = 0;
+
+            if (block == 0)  { break; }
+            _rank++;
+            continue;
+        }
+
+        size_t nb = std::min (len - total, block->data.size() - _blockIdx);
+        memcpy ((char*)buffer + total, block->data.data() + _blockIdx, nb);
+        total     += nb;
+        _blockIdx += nb;
+    }
+
+    /** Note that some data may have been read before the error (a truncated file for instance);
+     * we prefer to report the error than to silently provide a part of the file. */
+    if (hasError)  { return -1; }
+
+    _position += total;
+    return total;
+}
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
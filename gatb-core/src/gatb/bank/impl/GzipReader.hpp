@@ -0,0 +1,121 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file GzipReader.hpp
+ *  \brief Multi-threaded reader for gzip and BGZF files
+ */
+
+#ifndef _GATB_CORE_BANK_IMPL_GZIP_READER_HPP_
+#define _GATB_CORE_BANK_IMPL_GZIP_READER_HPP_
+
+/********************************************************************************/
+
+#include <gatb/system/api/types.hpp>
+
+#include <string>
+
+/********************************************************************************/
+namespace gatb      {
+namespace core      {
+namespace bank      {
+namespace impl      {
+/********************************************************************************/
+
+/** \brief Sequential reader of possibly compressed files, with multi-threaded inflation.
+ *
+ * This class offers the same service as the zlib gzopen/gzread functions, ie. it reads
+ * uncompressed or gzipped files in a transparent way. According to the kind of file, the
+ * inflation is done differently:
+ *   - BGZF files (blocked gzip, as produced by bgzip) are made of independent blocks
+ *     of at most 64KB; one thread reads the compressed blocks and a pool of threads
+ *     inflates them in parallel.
+ *   - other gzip files are inflated by a separate thread, so inflation is overlapped
+ *     with the processing of the data by the caller.
+ *   - uncompressed files are read in the calling thread.
+ *
+ * The threads are started at the first call to 'read' and stop by themselves at the
+ * end of the file.
+ *
+ * As for BankFasta::Iterator, the implementation types are hidden in the cpp file.
+ */
+class GzipReader
+{
+public:
+
+    /** Kind of the file to be read. */
+    enum Kind_e  {  UNCOMPRESSED, GZIP, BGZF  };
+
+    /** Constructor.
+     * \param[in] filename : path of the file to be read.
+     * \param[in] nbThreads : number of inflating threads for BGZF files (0 means number of cores). */
+    GzipReader (const std::string& filename, size_t nbThreads=0);
+
+    /** Destructor. */
+    ~GzipReader ();
+
+    /** Tells whether the file could be opened.
+     * \return true if the file is opened, false otherwise. */
+    bool isOpen () const  { return _kind != KIND_UNKNOWN; }
+
+    /** Get the kind of the read file.
+     * \return the kind. */
+    Kind_e getKind () const  { return (Kind_e) _kind; }
+
+    /** Read some uncompressed bytes (same semantics as gzread).
+     * \param[out] buffer : buffer to be filled
+     * \param[in] len : maximum number of bytes to be read.
+     * \return number of read bytes, 0 at the end of the file, -1 on error (corrupted or truncated file) */
+    int read (void* buffer, size_t len);
+
+    /** Go back to the beginning of the file. */
+    void rewind ();
+
+    /** Get the number of uncompressed bytes read so far.
+     * \return the number of bytes. */
+    u_int64_t tell () const  { return _position; }
+
+    /** Get the kind of a file by looking at its first bytes.
+     * \param[in] filename : path of the file
+     * \return the kind of the file. */
+    static Kind_e getKind (const std::string& filename);
+
+private:
+
+    enum { KIND_UNKNOWN = -1 };
+
+    std::string _filename;
+    size_t      _nbThreads;
+    int         _kind;
+    u_int64_t   _position;
+
+    void* _stream;     // gzFile for uncompressed files
+    void* _pipeline;   // inflate_pipeline_t
+    void* _block;      // inflated_block_t currently read
+    size_t _blockIdx;  // index of the next byte in the current block
+    u_int64_t _rank;   // rank of the next block to be read
+
+    void start ();
+    void stop  ();
+};
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_BANK_IMPL_GZIP_READER_HPP_ */
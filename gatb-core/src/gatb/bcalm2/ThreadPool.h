@@ -1,6 +1,7 @@
 // https://github.com/progschj/ThreadPool/blob/master/ThreadPool.h
 //
 // modified so that a thread_id integer in [0..nb_threads] is passed to each task
+// modified so that the workers are taken from the gatb-core WorkerPool instead of being created
 //
 // this is third-party code.
 /*
@@ -40,6 +41,8 @@ freely, subject to the following restrictions:
 #include <functional>
 #include <stdexcept>
 
+#include <gatb/system/impl/WorkerPool.hpp>
+
 class ThreadPool {
 public:
     ThreadPool(size_t);
@@ -50,7 +53,12 @@ public:
     void join();
 private:
     // need to keep track of threads so we can join them
-    std::vector< std::thread > workers;
+    std::vector< gatb::core::system::IThread* > workers;
+
+    // main loop of a worker, run by a thread of the WorkerPool
+    struct worker_arg { ThreadPool* pool; size_t thread_id; };
+    static void* mainloop (void* arg);
+    void run (size_t thread_id);
     // the task queue
     std::queue< std::function<void(int)> > tasks;
     
@@ -65,27 +73,37 @@ inline ThreadPool::ThreadPool(size_t threads)
     :   stop(false)
 {
     for(size_t thread_id = 0; thread_id<threads; ++ thread_id)
-        workers.emplace_back(
-            [this, thread_id]
-            {
-                for(;;)
-                {
-                    std::function<void(int)> task;
-
-                    {
-                        std::unique_lock<std::mutex> lock(this->queue_mutex);
-                        this->condition.wait(lock,
-                            [this]{ return this->stop || !this->tasks.empty(); });
-                        if(this->stop && this->tasks.empty())
-                            return;
-                        task = std::move(this->tasks.front());
-                        this->tasks.pop();
-                    }
-
-                    task(thread_id);
-                }
-            }
-        );
+        workers.push_back(gatb::core::system::impl::WorkerPool::singleton().newThread(
+            mainloop, new worker_arg { this, thread_id }
+        ));
+}
+
+inline void* ThreadPool::mainloop(void* arg)
+{
+    worker_arg* w = (worker_arg*) arg;
+    w->pool->run(w->thread_id);
+    delete w;
+    return 0;
+}
+
+inline void ThreadPool::run(size_t thread_id)
+{
+    for(;;)
+    {
+        std::function<void(int)> task;
+
+        {
+            std::unique_lock<std::mutex> lock(this->queue_mutex);
+            this->condition.wait(lock,
+                [this]{ return this->stop || !this->tasks.empty(); });
+            if(this->stop && this->tasks.empty())
+                return;
+            task = std::move(this->tasks.front());
+            this->tasks.pop();
+        }
+
+        task(thread_id);
+    }
 }
 
 // add new work item to the pool
@@ -123,8 +141,13 @@ void ThreadPool::join()
         stop = true;
     }
     condition.notify_all();
-    for(std::thread &worker: workers)
-        worker.join();
+    // deleting a thread gives it back to the WorkerPool
+    for(gatb::core::system::IThread* worker: workers)
+    {
+        worker->join();
+        delete worker;
+    }
+    workers.clear();
 }
 
 #endif
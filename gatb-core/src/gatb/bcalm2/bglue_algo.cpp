@@ -481,6 +481,35 @@ class hasher_t
     
 typedef uint64_t partition_t;
 
+/* UF class of each marked kmer, once the UF is computed. The classes are stored on 32 bits, as
+ * before the 64-bit UF, unless there are more than 2^32 marked kmers */
+class uf_classes
+{
+    std::vector<uint32_t> classes32;
+    std::vector<uint64_t> classes64;
+
+    public:
+    uf_classes(uint64_t size)
+    {
+        if (size <= ((uint64_t)1 << 32))
+            classes32.resize(size);
+        else
+            classes64.resize(size);
+    }
+
+    int bits() const { return classes64.empty() ? 32 : 64; }
+
+    void set(uint64_t i, uint64_t ufclass)
+    {
+        if (classes64.empty())
+            classes32[i] = ufclass;
+        else
+            classes64[i] = ufclass;
+    }
+
+    uint64_t operator[](uint64_t i) const { return classes64.empty() ? classes32[i] : classes64[i]; }
+};
+
 /* computes and uniquifies the hashes of marked kmers at extremities of all to-be-glued sequences */
 template <int SPAN>
 void prepare_uf(std::string prefix, IBank *in, const int nb_threads, int& kmerSize, int pass, int nb_passes, uint64_t &nb_elts, uint64_t estimated_nb_glue_sequences)
@@ -768,7 +797,8 @@ void bglue(Storage *storage,
 
     // create a UF data structure
     // this one stores nb_uf_keys * uint64_t (actually, atomic's). so it's bigger than uf_hashes
-    unionFind ufkmers(nb_uf_keys);
+    // it has 64 bits ids (the former unionFind was limited to 2^32 marked kmers)
+    unionFind64 ufkmers(nb_uf_keys);
 
 #if 0
     unionFind<unsigned int> ufmin;
@@ -791,8 +821,12 @@ void bglue(Storage *storage,
         const string comment = (*it)->getComment();
     */
     
+    // unions are made by batches of pairs, one batch per thread (see unionFind64::unite_batch)
+    const size_t uf_batch_size = 10000;
+    ThreadObject<std::vector<std::pair<uint64_t, uint64_t>>> uf_batches;
+
     auto createUF = [k, &modelCanon, \
-        &uf_mphf, &ufkmers, &hasher](const Sequence& sequence)
+        &uf_mphf, &ufkmers, &hasher, &uf_batches, uf_batch_size](const Sequence& sequence)
     {
         const string seq = sequence.toString();
         const string comment = sequence.getComment();
@@ -815,10 +849,13 @@ void bglue(Storage *storage,
         const typename ModelCanon::Kmer kmmerBegin = modelCanon.codeSeed(kmerBegin.c_str(), Data::ASCII);
         const typename ModelCanon::Kmer kmmerEnd = modelCanon.codeSeed(kmerEnd.c_str(), Data::ASCII);
 
-        uint32_t v1 = uf_mphf.lookup(hasher(kmmerBegin));
-        uint32_t v2 = uf_mphf.lookup(hasher(kmmerEnd));
+        uint64_t v1 = uf_mphf.lookup(hasher(kmmerBegin));
+        uint64_t v2 = uf_mphf.lookup(hasher(kmmerEnd));
 
-        ufkmers.union_(v1,v2);
+        std::vector<std::pair<uint64_t, uint64_t>>& batch = uf_batches();
+        batch.push_back(std::make_pair(v1,v2));
+        if (batch.size() == uf_batch_size)
+            ufkmers.unite_batch(batch);
         //ufkmers.union_((hasher(kmmerBegin)), (hasher(kmmerEnd)));
 
 #if 0
@@ -847,6 +884,9 @@ void bglue(Storage *storage,
 
     Dispatcher dispatcher (nb_threads);
     dispatcher.iterate (in->iterator(), createUF);
+
+    // unite the remaining pairs of each thread
+    uf_batches.foreach ([&ufkmers] (std::vector<std::pair<uint64_t, uint64_t>>& batch) { ufkmers.unite_batch(batch); });
     
 #if 0
     ufmin.printStats("uf minimizers");
@@ -892,15 +932,15 @@ void bglue(Storage *storage,
 
     ufkmers_bag->flush();
 
-    std::vector<uint32_t > ufkmers_vector(nb_uf_keys);
+    uf_classes ufkmers_vector(nb_uf_keys);
     IteratorFile<uint64_t> ufkmers_file(prefix+".glue.uf");
     unsigned long i = 0;
     for (ufkmers_file.first(); !ufkmers_file.isDone(); ufkmers_file.next())
-            ufkmers_vector[i++] = ufkmers_file.item();
+            ufkmers_vector.set(i++, ufkmers_file.item());
 
     System::file().remove (prefix+".glue.uf");
     
-    logging("loaded 32-bit UF (" + to_string(nb_uf_keys*sizeof(uint32_t)/1024/1024) + " MB)");
+    logging("loaded " + to_string(ufkmers_vector.bits()) + "-bit UF (" + to_string(nb_uf_keys*ufkmers_vector.bits()/8/1024/1024) + " MB)");
   
     // setup output file
     string output_prefix = prefix;
@@ -913,7 +953,7 @@ void bglue(Storage *storage,
          bool &found_class)
         {
             found_class = false;
-            uint32_t ufclass = 0;
+            uint64_t ufclass = 0;
 
             if (lmark)
             {
@@ -981,7 +1021,7 @@ void bglue(Storage *storage,
 
         bool found_class = false;
 
-        uint32_t ufclass = get_UFclass(kmerBegin, kmerEnd, lmark, rmark, kmmerBegin, kmmerEnd, found_class);
+        uint64_t ufclass = get_UFclass(kmerBegin, kmerEnd, lmark, rmark, kmmerBegin, kmmerEnd, found_class);
 
         if (!found_class) // this one doesn't need to be glued
         {
@@ -1060,7 +1100,7 @@ void bglue(Storage *storage,
             }
             outLock.unlock();
 
-            unordered_map<int, vector< markedSeq<SPAN> >> msInPart;
+            unordered_map<uint64_t, vector< markedSeq<SPAN> >> msInPart;
             uint64_t seq_index = 0;
 
             for (it.first(); !it.isDone(); it.next()) // BankFasta
@@ -1071,7 +1111,7 @@ void bglue(Storage *storage,
                 const string kmerBegin = seq.substr(0, k );
                 const string kmerEnd = seq.substr(seq.size() - k , k );
 
-                uint32_t ufclass = 0;
+                uint64_t ufclass = 0;
                 bool found_class = false;
 
                 bool lmark = comment[0] == '1';
@@ -180,6 +180,138 @@ public:
     mutable std::vector<std::atomic<uint64_t>> mData;
 };
 
+/**
+ * Same lock-free union-find as unionFind, with 64 bits element ids, for more than 2^32 elements.
+ *
+ * An element still takes a single 64 bits word: the rank (at most log2 of the number of elements)
+ * is stored in the 8 upper bits and the parent in the 56 lower bits.
+ *
+ * unite_batch() unites a batch of pairs while prefetching the elements (and their parents) of the
+ * next pairs, so that the cache misses of consecutive unions on the (large) array overlap.
+ */
+class unionFind64 {
+public:
+    static const int      RANK_SHIFT  = 56;
+    static const uint64_t PARENT_MASK = (1ULL << RANK_SHIFT) - 1;
+
+    unionFind64(uint64_t size) : mData(size) {
+        if (size > PARENT_MASK) {std::cout << "error: too many elements in the UF (" << size << ")" << std::endl; exit(1);}
+        for (uint64_t i=0; i<size; ++i)
+            mData[i] = i;
+    }
+
+    uint64_t find(uint64_t id) const {
+        while (id != parent(id)) {
+            uint64_t value = mData[id];
+            uint64_t new_parent = parent(value & PARENT_MASK);
+            uint64_t new_value =
+                (value & ~PARENT_MASK) | new_parent;
+            /* Try to update parent (may fail, that's ok) */
+            if (value != new_value)
+                mData[id].compare_exchange_weak(value, new_value);
+            id = new_parent;
+        }
+        return id;
+    }
+
+    bool same(uint64_t id1, uint64_t id2) const {
+        for (;;) {
+            id1 = find(id1);
+            id2 = find(id2);
+            if (id1 == id2)
+                return true;
+            if (parent(id1) == id1)
+                return false;
+        }
+    }
+
+    uint64_t union_(uint64_t id1, uint64_t id2) {
+        for (;;) {
+            id1 = find(id1);
+            id2 = find(id2);
+
+            if (id1 == id2)
+                return id1;
+
+            uint64_t r1 = rank(id1), r2 = rank(id2);
+
+            if (r1 > r2 || (r1 == r2 && id1 < id2)) {
+                std::swap(r1, r2);
+                std::swap(id1, id2);
+            }
+
+            uint64_t oldEntry = (r1 << RANK_SHIFT) | id1;
+            uint64_t newEntry = (r1 << RANK_SHIFT) | id2;
+
+            if (!mData[id1].compare_exchange_strong(oldEntry, newEntry))
+                continue;
+
+            if (r1 == r2) {
+                oldEntry = (r2 << RANK_SHIFT) | id2;
+                newEntry = ((r2+1) << RANK_SHIFT) | id2;
+                /* Try to update the rank (may fail, that's ok) */
+                mData[id2].compare_exchange_weak(oldEntry, newEntry);
+            }
+
+            break;
+        }
+        return id2;
+    }
+
+    // unites all the pairs of the batch (which is emptied), can be called concurrently
+    void unite_batch(std::vector<std::pair<uint64_t, uint64_t>>& batch) {
+        const size_t distance = 16;
+        for (size_t i = 0; i < batch.size(); i++)
+        {
+            if (i + distance < batch.size())
+            {
+                __builtin_prefetch(&mData[batch[i+distance].first]);
+                __builtin_prefetch(&mData[batch[i+distance].second]);
+            }
+            if (i + distance/2 < batch.size())
+            {
+                __builtin_prefetch(&mData[parent(batch[i+distance/2].first)]);
+                __builtin_prefetch(&mData[parent(batch[i+distance/2].second)]);
+            }
+            union_(batch[i].first, batch[i].second);
+        }
+        batch.clear();
+    }
+
+    uint64_t size() const { return mData.size(); }
+
+    uint64_t rank(uint64_t id) const {
+        return mData[id] >> RANK_SHIFT;
+    }
+
+    uint64_t parent(uint64_t id) const {
+        return mData[id] & PARENT_MASK;
+    }
+
+    // compatibility with original unionFind.cpp
+    uint64_t getSet(uint64_t key) { return find(key); }
+
+    void printStats(std::string prefix)
+    {
+        std::unordered_map<uint64_t, uint64_t> classSizes;
+        for (uint64_t i = 0; i < size(); i++)
+            classSizes[find(i)]++; // need to call find, because element isn't necessarily the representant of its equivalence class
+        uint64_t mean = 0, max = 0;
+        for ( auto it = classSizes.begin(); it != classSizes.end(); ++it )
+        {
+            max = std::max(it->second, max);
+            mean += it->second;
+        }
+        if (classSizes.size() > 0)
+            mean /= classSizes.size();
+        std::cout << prefix + " data structure has " << size() << " inserted elements, and made " << classSizes.size() << " partitions." << std::endl;
+        std::cout << "mean/max number of elements in partitions: " << mean << "/" << max << std::endl;
+        std::cout << "raw space of UF data: " << ( size() * sizeof(uint64_t)  ) /1024/1024 << " MB" << std::endl;
+    }
+
+    mutable std::vector<std::atomic<uint64_t>> mData;
+};
+
 #endif /* __UNIONFIND_H */
 
 // this one below works fine but uses an unordered_map; so two problem:
@@ -55,6 +55,12 @@ public:
     /** Tells whether an item exists or not in the container
      * \return true if the item exists, false otherwise */
     virtual bool contains (const Item& item) = 0;
+
+    /** Get the abundance of an item, for containers storing abundances.
+     * \param[in] item : the item
+     * \param[out] abundance : the abundance of the item (0 if not found), or a lower bound of it
+     * \return false if the container doesn't know the exact abundance (not stored, or lower bound). */
+    virtual bool getAbundance (const Item& item, u_int64_t& abundance)  {  return false;  }
 };
 
 /********************************************************************************/
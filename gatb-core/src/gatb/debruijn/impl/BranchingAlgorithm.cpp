@@ -237,7 +237,7 @@ void BranchingAlgorithm<span, Node, Edge, Graph>::execute ()
     FunctorNodes<Count,Type, Node, Edge, Graph> functorNodes (this->_graph, functorData);
 
     /** We iterate the nodes. */
-    tools::dp::IDispatcher::Status status = getDispatcher()->iterate (iter, functorNodes);
+    tools::dp::IDispatcher::Status status = getDispatcher()->iterateSplit (iter, functorNodes);
 
     /** Now, because we iterated with N threads, we have N vector of branching nodes. (N=nbcores used by the dispatcher)
      *  We need to merge them.
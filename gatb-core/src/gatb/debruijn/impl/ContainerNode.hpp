@@ -29,6 +29,7 @@
 /********************************************************************************/
 
 #include <gatb/debruijn/api/IContainerNode.hpp>
+#include <gatb/tools/collections/impl/QuotientFilter.hpp>
 #include <cstdarg>
 
 /********************************************************************************/
@@ -73,6 +74,14 @@ public:
     /** \copydoc IContainerNode::contains */
     bool contains (const Item& item)  {  return (_bloom->contains(item) && !_falsePositives->contains(item));  }
 
+    /** \copydoc tools::collections::Container::containsN
+     * The Bloom filter is queried for all the items at once; the cFP set is queried only for the found items. */
+    void containsN (const Item* items, size_t n, bool* out)
+    {
+        _bloom->containsN (items, n, out);
+        for (size_t i=0; i<n; i++)  {  if (out[i])  { out[i] = !_falsePositives->contains(items[i]); }  }
+    }
+
 protected:
 
     tools::collections::Container<Item>* _bloom;
@@ -99,6 +108,9 @@ public:
 
     /** \copydoc IContainerNode::contains */
     bool contains (const Item& item)  {  return (this->_bloom)->contains(item);  }
+
+    /** \copydoc tools::collections::Container::containsN */
+    void containsN (const Item* items, size_t n, bool* out)  {  (this->_bloom)->containsN (items, n, out);  }
 };
 
 /********************************************************************************/
@@ -150,6 +162,14 @@ public:
     /** \copydoc IContainerNode::contains */
     bool contains (const Item& item)  {  return (_bloom->contains(item) && ! containsCFP(item));  }
 
+    /** \copydoc tools::collections::Container::containsN
+     * The Bloom filter is queried for all the items at once; the cFP set is queried only for the found items. */
+    void containsN (const Item* items, size_t n, bool* out)
+    {
+        _bloom->containsN (items, n, out);
+        for (size_t i=0; i<n; i++)  {  if (out[i])  { out[i] = !containsCFP(items[i]); }  }
+    }
+
 private:
 
     tools::collections::Container<Item>* _bloom;
@@ -185,6 +205,48 @@ private:
 
 };
 
+/********************************************************************************/
+/** \brief IContainerNode implementation with a counting quotient filter
+ *
+ * The quotient filter holds all the solid kmers with their abundance, so there is no
+ * cFP set: the only false positives are fingerprint collisions. The abundance of a kmer
+ * is its counter in the filter, unless the counter is saturated.
+ */
+template <typename Item> class ContainerNodeQuotient : public IContainerNode<Item>, public system::SmartPointer
+{
+public:
+
+    /** Constructor
+     * \param[in] filter : the quotient filter. */
+    ContainerNodeQuotient (tools::collections::impl::QuotientFilter<Item>* filter) : _filter(0)  {  setFilter (filter);  }
+
+    /** Destructor */
+    ~ContainerNodeQuotient ()  {  setFilter (0);  }
+
+    /** \copydoc IContainerNode::contains */
+    bool contains (const Item& item)  {  return _filter->contains (item);  }
+
+    /** \copydoc tools::collections::Container::containsN */
+    void containsN (const Item* items, size_t n, bool* out)  {  _filter->containsN (items, n, out);  }
+
+    /** \copydoc IContainerNode::getAbundance
+     * A saturated counter is only a lower bound of the abundance. */
+    bool getAbundance (const Item& item, u_int64_t& abundance)
+    {
+        abundance = _filter->getCount (item);
+        return abundance < ((u_int64_t)1 << _filter->getCounterBits()) - 1;
+    }
+
+    /** Get the quotient filter.
+     * \return the filter. */
+    tools::collections::impl::QuotientFilter<Item>* getFilter ()  { return _filter; }
+
+private:
+
+    tools::collections::impl::QuotientFilter<Item>* _filter;
+    void setFilter (tools::collections::impl::QuotientFilter<Item>* filter)  { SP_SETATTR(filter); }
+};
+
 /********************************************************************************/
 } } } } /* end of namespaces. */
 /********************************************************************************/
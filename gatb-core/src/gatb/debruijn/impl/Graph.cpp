@@ -229,6 +229,7 @@ void configure_visitor<Node,Edge,GraphDataVariant>::operator() (GraphData<span>&
 
         data.setAbundance (mphf_algo.getAbundanceMap());
         data.setNodeState (mphf_algo.getNodeStateMap());
+        data.createDeleted ();
         data.setAdjacency (mphf_algo.getAdjacencyMap());
     }
 }
@@ -493,6 +494,7 @@ void build_visitor_postsolid<Node,Edge,GraphDataVariant>::operator() (GraphData<
         graph.executeAlgorithm (mphf_algo, & graph.getStorage(), props, graph._info);
         data.setAbundance(mphf_algo.getAbundanceMap());
         data.setNodeState(mphf_algo.getNodeStateMap());
+        data.createDeleted();
         data.setAdjacency(mphf_algo.getAdjacencyMap());
         graph.setState(GraphTemplate<Node, Edge, GraphDataVariant>::STATE_MPHF_DONE);
 
@@ -506,13 +508,14 @@ void build_visitor_postsolid<Node,Edge,GraphDataVariant>::operator() (GraphData<
     {
         DEBUG ((cout << "build_visitor : BloomAlgorithm BEGIN\n"));
 
-        if (graph._bloomKind != BLOOM_NONE)
+        /** The quotient filter debloom doesn't need a Bloom filter. */
+        if (graph._bloomKind != BLOOM_NONE && graph._debloomKind != DEBLOOM_QUOTIENT)
         {
             BloomAlgorithm<span> bloomAlgo (
                     graph.getStorage(),
                     data._solid,
                     kmerSize,
-                    DebloomAlgorithm<span>::getNbBitsPerKmer (kmerSize, graph._debloomKind),
+                    DebloomAlgorithm<span>::getNbBitsPerKmer (kmerSize, graph._debloomKind, graph._bloomKind),
                     props->get(STR_NB_CORES)   ? props->getInt(STR_NB_CORES)   : 0,
                     graph._bloomKind
                     );
@@ -526,7 +529,10 @@ void build_visitor_postsolid<Node,Edge,GraphDataVariant>::operator() (GraphData<
     /************************************************************/
     /*                         Debloom                          */
     /************************************************************/
-    if (graph.checkState(GraphTemplate<Node, Edge, GraphDataVariant>::STATE_BLOOM_DONE) && !(graph.checkState(GraphTemplate<Node, Edge, GraphDataVariant>::STATE_DEBLOOM_DONE)))
+    bool bloomReady = graph.checkState(GraphTemplate<Node, Edge, GraphDataVariant>::STATE_BLOOM_DONE)
+        || (graph._debloomKind == DEBLOOM_QUOTIENT && graph.checkState(GraphTemplate<Node, Edge, GraphDataVariant>::STATE_SORTING_COUNT_DONE));
+
+    if (bloomReady && !(graph.checkState(GraphTemplate<Node, Edge, GraphDataVariant>::STATE_DEBLOOM_DONE)))
     {
         DEBUG ((cout << "build_visitor : DebloomAlgorithm BEGIN\n"));
 
@@ -656,6 +662,7 @@ IOptionsParser* GraphTemplate<Node, Edge, GraphDataVariant>::getOptionsParser (b
     OptionsParser* parserDebug = new OptionsParser ("debug ");
 
     // those are only valid for GraphUnitigs, but GraphUnitigs doesn't have custom options (yet) so i'm adding here
+    parserDebug->push_front (new OptionNoParam  ("-unitigs-snapshot",   "keep a binary snapshot of the loaded unitigs next to the unitigs file, and load it instead of the unitigs file when up to date"));
     parserDebug->push_front (new OptionOneParam ("-nb-glue-partitions",       "number of glue partitions (automatically calculated by default)", false, "0"));
     //parserDebug->push_front (new OptionNoParam  ("-rebuild-graph",       "rebuild the whole graph starting from counted kmers"));
     parserDebug->push_front (new OptionNoParam  ("-skip-links",       "same, but       skip     links"));
@@ -1287,34 +1294,28 @@ struct getItems_visitor : public boost::static_visitor<GraphVector<Item> >    {
             return itemsAdj;
         }
 
-        /* else, run classical neighbor queries using the data.contains() operation (bloom filters behind the scenes) */
+        /* else, run classical neighbor queries using the data.containsN() operation (bloom filters behind the scenes);
+         * the (up to 8) neighbors are queried at once, so their Bloom filter lookups overlap. */
+        Type       neighbors [8];
+        Strand     strands   [8];
+        Nucleotide nts       [8];
+        Direction  dirs      [8];
+        bool       found     [8];
+        size_t     nbNeighbors = 0;
 
         if (direction & DIR_OUTCOMING)
         {
             for (u_int64_t nt=0; nt<4; nt++)
             {
-                typename Node::Value dest_value;
                 Type forward = ( (graine << 2 )  + nt) & mask;
                 Type reverse = revcomp (forward, kmerSize);
 
-                if (forward < reverse)
-                {
-                    if (data.contains (forward))
-                    {
-                        dest_value = forward;
-                        if (debug) std::cout << "kmer  "<< sourceVal << " found OUT FWD nt=" << nt << std::endl;
-                        fct (items, idx++, source.kmer, source.strand, dest_value, STRAND_FORWARD, (Nucleotide)nt, DIR_OUTCOMING);
-                    }
-                }
-                else
-                {
-                    if (data.contains (reverse))
-                    {
-                        dest_value = reverse;
-                        if (debug) std::cout << "found OUT REV nt=" << nt << std::endl;
-                        fct (items, idx++, source.kmer, source.strand, dest_value, STRAND_REVCOMP, (Nucleotide)nt, DIR_OUTCOMING);
-                    }
-                }
+                if (forward < reverse)  {  neighbors[nbNeighbors] = forward;  strands[nbNeighbors] = STRAND_FORWARD;  }
+                else                    {  neighbors[nbNeighbors] = reverse;  strands[nbNeighbors] = STRAND_REVCOMP;  }
+
+                nts [nbNeighbors] = (Nucleotide)nt;
+                dirs[nbNeighbors] = DIR_OUTCOMING;
+                nbNeighbors++;
             }
         }
 
@@ -1326,29 +1327,29 @@ struct getItems_visitor : public boost::static_visitor<GraphVector<Item> >    {
                 Type single_nt;
                 single_nt.setVal(nt);
                 single_nt <<=  ((kmerSize-1)*2);
-                typename Node::Value dest_value;
                 Type forward = ((graine >> 2 )  + single_nt ) & mask; /* previous kmer */
                 Type reverse = revcomp (forward, kmerSize);
 
-                if (forward < reverse)
-                {
-                    if (data.contains (forward))
-                    {
-                        dest_value = forward;
-                        if (debug) std::cout << "found INC FWD nt=" << nt << std::endl;
-                        // It used to be that "nt" was source[0] (in forward strand) and reverse(source[k-1]) in reverse, but i think it was wrong, so i changed it. TODO: delete this line if neighbors(..,DIR_INCOMING) causes no trouble for anyone, as it is now.
-                        fct (items, idx++, source.kmer, source.strand, dest_value, STRAND_FORWARD, (Nucleotide)nt, DIR_INCOMING);
-                    }
-                }
-                else
-                {
-                    if (data.contains (reverse))
-                    {
-                        dest_value = reverse;
-                        if (debug) std::cout << "found INC REV nt=" << nt << std::endl;
-                        fct (items, idx++, source.kmer, source.strand, dest_value, STRAND_REVCOMP, (Nucleotide)nt, DIR_INCOMING);
-                    }
-                }
+                if (forward < reverse)  {  neighbors[nbNeighbors] = forward;  strands[nbNeighbors] = STRAND_FORWARD;  }
+                else                    {  neighbors[nbNeighbors] = reverse;  strands[nbNeighbors] = STRAND_REVCOMP;  }
+
+                // It used to be that "nt" was source[0] (in forward strand) and reverse(source[k-1]) in reverse, but i think it was wrong, so i changed it. TODO: delete this line if neighbors(..,DIR_INCOMING) causes no trouble for anyone, as it is now.
+                nts [nbNeighbors] = (Nucleotide)nt;
+                dirs[nbNeighbors] = DIR_INCOMING;
+                nbNeighbors++;
+            }
+        }
+
+        data.containsN (neighbors, nbNeighbors, found);
+
+        for (size_t i=0; i<nbNeighbors; i++)
+        {
+            if (found[i])
+            {
+                typename Node::Value dest_value;
+                dest_value = neighbors[i];
+                if (debug) std::cout << "kmer  "<< sourceVal << " found " << (dirs[i]==DIR_OUTCOMING ? "OUT " : "INC ") << (strands[i]==STRAND_REVCOMP ? "REV" : "FWD") << " nt=" << nts[i] << std::endl;
+                fct (items, idx++, source.kmer, source.strand, dest_value, strands[i], nts[i], dirs[i]);
             }
         }
 
@@ -1477,6 +1478,11 @@ struct countNeighbors_visitor : public boost::static_visitor<void>    {
         /* TODO opt: in some cases we may skip computing graine, e.g. whenever there are no neighbors */
 
 
+        /* the (up to 8) neighbors are queried at once, so their Bloom filter lookups overlap. */
+        Type   neighbors [8];
+        bool   found     [8];
+        size_t nbOut = 0, nbIn = 0;
+
         if (direction & DIR_OUTCOMING)
         {
             for (u_int64_t nt=0; nt<4; nt++)
@@ -1484,20 +1490,7 @@ struct countNeighbors_visitor : public boost::static_visitor<void>    {
                 Type forward = ( (graine << 2 )  + nt) & mask;
                 Type reverse = revcomp (forward, kmerSize);
 
-                if (forward < reverse)
-                {
-                    if (data.contains (forward))
-                    {
-                        outdegree++;
-                    }
-                }
-                else
-                {
-                    if (data.contains (reverse))
-                    {
-                        outdegree++;
-                    }
-                }
+                neighbors[nbOut++] = std::min (forward, reverse);
             }
         }
 
@@ -1512,22 +1505,14 @@ struct countNeighbors_visitor : public boost::static_visitor<void>    {
                 Type forward = ((graine >> 2 )  + single_nt ) & mask; /* previous kmer */
                 Type reverse = revcomp (forward, kmerSize);
 
-                if (forward < reverse)
-                {
-                    if (data.contains (forward))
-                    {
-                        indegree++;
-                    }
-                }
-                else
-                {
-                    if (data.contains (reverse))
-                    {
-                        indegree++;
-                    }
-                }
+                neighbors[nbOut + nbIn++] = std::min (forward, reverse);
             }
         }
+
+        data.containsN (neighbors, nbOut+nbIn, found);
+
+        for (size_t i=0;     i<nbOut;      i++)  {  if (found[i])  { outdegree++; }  }
+        for (size_t i=nbOut; i<nbOut+nbIn; i++)  {  if (found[i])  { indegree++;  }  }
     }
 };
 
@@ -2322,6 +2307,19 @@ struct nodes_visitor : public boost::static_visitor<tools::dp::ISmartIterator<No
             /** */
             u_int64_t size () const { return _nbItems; }
 
+            /** The iteration can be split according to the composition of the referred iterator,
+             * typically one part per partition of the solid kmers (see IDispatcher::iterateSplit). */
+            std::vector<tools::dp::Iterator<NodeType>*> getComposition()
+            {
+                std::vector<tools::dp::Iterator<NodeType>*> result;
+
+                std::vector<tools::dp::Iterator<Count>*> refs = _ref->getComposition();
+                if (refs.size() <= 1)  { result.push_back (this);  return result; }
+
+                for (size_t i=0; i<refs.size(); i++)  {  result.push_back (new NodeIterator (refs[i], 0));  }
+                return result;
+            }
+
         private:
             tools::dp::Iterator<Count>* _ref;
             void setRef (tools::dp::Iterator<Count>* ref)  { SP_SETATTR(ref); }
@@ -3250,6 +3248,11 @@ struct queryAbundance_visitor : public boost::static_visitor<int>    {
 
     template<size_t span>  int operator() (const GraphData<span>& data) const
     {
+        /** The node container may know the abundance (quotient filter), otherwise we use the MPHF. */
+        u_int64_t abundance = 0;
+        bool      known     = data._container != 0 && data._container->getAbundance (node.template getKmer<typename Kmer<span>::Type>(), abundance);
+        if (known || (abundance > 0 && data._abundance == 0))  { return abundance; }
+
         unsigned long hashIndex = getNodeIndex<span>(data, node);
     	if(hashIndex == ULLONG_MAX) return 0; // node was not found in the mphf 
 
@@ -3324,6 +3327,9 @@ struct setNodeState_visitor : public boost::static_visitor<int>    {
 
         int maskedState = state & 0xF;
 
+        /** A deleted node goes into the filter of deleted nodes (never removed, but the state is checked). */
+        if ((maskedState & 2) && data._deleted != NULL)  {  data._deleted->insert (node.template getKmer<typename Kmer<span>::Type>());  }
+
         if (hashIndex % 2 == 1)
         {
             value &= 0xF;
@@ -3354,6 +3360,7 @@ struct resetNodeState_visitor : public boost::static_visitor<int>    {
     template<size_t span> int operator() (const GraphData<span>& data) const
     {
         (*(data._nodestate)).clearData();
+        if (data._deleted != NULL)  {  System::memory().memset (data._deleted->getArray(), 0, data._deleted->getSize());  }
         return 0;
     }
 };
@@ -3373,13 +3380,14 @@ struct disableNodeState_visitor : public boost::static_visitor<int>    {
     template<size_t span> int operator() (GraphData<span>& data) const
     {
         data._nodestate = NULL;
+        data.setDeleted (0);
         return 0;
     }
 };
 
 /* this can be useful for benchmarking purpose.
- * because contains() always does a MPHF query to check if the node is deleted or not
- * unless _nodestate is NULL.
+ * because contains() checks if the node is deleted or not (filter of deleted nodes, then
+ * MPHF query) unless _nodestate is NULL.
  * thus, this functions sets _nodestate to NULL.
  * NOTE: irreversible!
  */
@@ -3839,6 +3847,56 @@ struct cached_nodes_visitor : public boost::static_visitor<tools::dp::ISmartIter
     // we should really use STL iterators in the next rewrite.
     template<size_t span>  tools::dp::ISmartIterator<Node>* operator() (const GraphData<span>& data) const
     {
+        /** Iterator on a range of buckets of the nodes cache, used for splitting the iteration. */
+        class CachedBucketsIterator : public tools::dp::Iterator<Node>
+        {
+        public:
+            CachedBucketsIterator (typename GraphData<span>::NodeCacheMap *nodecache, size_t firstBucket, size_t endBucket)
+                : _nodecache(nodecache), _firstBucket(firstBucket), _endBucket(endBucket), _bucket(0), _isDone(true)  {}
+
+            /** \copydoc  Iterator::first */
+            void first()
+            {
+                _bucket = _firstBucket;
+                _isDone = _bucket >= _endBucket;
+                if (!_isDone)  {  _it = _nodecache->begin(_bucket);  update();  }
+            }
+
+            /** \copydoc  Iterator::next */
+            void next()  {  _it++;  update();  }
+
+            /** \copydoc  Iterator::isDone */
+            bool isDone() { return _isDone;  }
+
+            /** \copydoc  Iterator::item */
+            Node& item ()  {  return *(this->_item);  }
+
+            /** */
+            void setItem (Node& i)  {  this->_item = &i;  this->_item->strand = STRAND_FORWARD;  }
+
+        private:
+            typename GraphData<span>::NodeCacheMap *_nodecache;
+            typename GraphData<span>::NodeCacheMap::local_iterator _it;
+
+            size_t _firstBucket;
+            size_t _endBucket;
+            size_t _bucket;
+            bool   _isDone;
+
+            /** We skip the empty buckets and set the current item. */
+            void update ()
+            {
+                while (_it == _nodecache->end(_bucket))
+                {
+                    if (++_bucket >= _endBucket)  {  _isDone = true;  return;  }
+                    _it = _nodecache->begin(_bucket);
+                }
+                this->_item->kmer      = _it->first;
+                this->_item->abundance = 0; // not recorded
+                this->_item->mphfIndex = 0;
+            }
+        };
+
         class CachedNodeIterator : public tools::dp::ISmartIterator<Node>
         {
         public:
@@ -3891,6 +3949,21 @@ struct cached_nodes_visitor : public boost::static_visitor<tools::dp::ISmartIter
             /** */
             u_int64_t size () const { return _nodecache->size(); }
 
+            /** The iteration can be split in ranges of buckets of the nodes cache (see IDispatcher::iterateSplit). */
+            std::vector<tools::dp::Iterator<Node>*> getComposition()
+            {
+                std::vector<tools::dp::Iterator<Node>*> result;
+
+                size_t nbBuckets = _nodecache->bucket_count();
+                size_t nbParts   = std::min (nbBuckets, (size_t)1024);
+
+                for (size_t i=0; i<nbParts; i++)
+                {
+                    result.push_back (new CachedBucketsIterator (_nodecache, (nbBuckets*i)/nbParts, (nbBuckets*(i+1))/nbParts));
+                }
+                return result;
+            }
+
         private:
             typename GraphData<span>::NodeCacheMap *_nodecache;
             typename GraphData<span>::NodeCacheMap::iterator _it;
@@ -466,6 +466,9 @@ class GraphIterator : public tools::dp::ISmartIterator<Item>
         /** */
         tools::dp::ISmartIterator<Item>* get()  const { return _ref; }
 
+        /** */
+        std::vector<tools::dp::Iterator<Item>*> getComposition()  { return _ref->getComposition(); }
+
     private:
 
         tools::dp::ISmartIterator<Item>* _ref;
@@ -1180,7 +1183,7 @@ struct GraphData
     typedef typename std::unordered_map<Type, std::pair<char,std::string>, NodeHasher<Type> > NodeCacheMap; // rudimentary for now
 
     /** Constructor. */
-    GraphData () : _model(0), _solid(0), _container(0), _branching(0), _abundance(0), _nodestate(0), _adjacency(0), _nodecache(0) {}
+    GraphData () : _model(0), _solid(0), _container(0), _branching(0), _abundance(0), _nodestate(0), _deleted(0), _adjacency(0), _nodecache(0) {}
 
     /** Destructor. */
     ~GraphData ()
@@ -1191,12 +1194,13 @@ struct GraphData
         setBranching (0);
         setAbundance (0);
         setNodeState (0);
+        setDeleted   (0);
         setAdjacency (0);
         setNodeCache (0);
     }
 
     /** Constructor (copy). */
-    GraphData (const GraphData& d) : _model(0), _solid(0), _container(0), _branching(0), _abundance(0), _nodestate(0), _adjacency(0), _nodecache(0)
+    GraphData (const GraphData& d) : _model(0), _solid(0), _container(0), _branching(0), _abundance(0), _nodestate(0), _deleted(0), _adjacency(0), _nodecache(0)
     {
         setModel     (d._model);
         setSolid     (d._solid);
@@ -1204,6 +1208,7 @@ struct GraphData
         setBranching (d._branching);
         setAbundance (d._abundance);
         setNodeState (d._nodestate);
+        setDeleted   (d._deleted);
         setAdjacency (d._adjacency);
         setNodeCache (d._nodecache);
     }
@@ -1219,6 +1224,7 @@ struct GraphData
             setBranching (d._branching);
             setAbundance (d._abundance);
             setNodeState (d._nodestate);
+            setDeleted   (d._deleted);
             setAdjacency (d._adjacency);
             setNodeCache (d._nodecache);
         }
@@ -1232,6 +1238,7 @@ struct GraphData
     tools::collections::Collection<Count>*    _branching;
     AbundanceMap*         _abundance;
     NodeStateMap*         _nodestate;
+    tools::collections::impl::IBloom<Type>*   _deleted; // Bloom filter of the nodes that have been deleted once
     AdjacencyMap*         _adjacency;
     NodeCacheMap*         _nodecache; // so, nodecache also records branching node, but also more stuff. i'm keeping _branching for historical reasons.
 
@@ -1242,9 +1249,21 @@ struct GraphData
     void setBranching   (tools::collections::Collection<Count>*   branching)  { SP_SETATTR (branching); }
     void setAbundance   (AbundanceMap*          abundance)  { SP_SETATTR (abundance); }
     void setNodeState   (NodeStateMap*          nodestate)  { SP_SETATTR (nodestate); }
+    void setDeleted     (tools::collections::impl::IBloom<Type>* deleted)  { SP_SETATTR (deleted); }
     void setAdjacency   (AdjacencyMap*          adjacency)  { SP_SETATTR (adjacency); }
     void setNodeCache   (NodeCacheMap*          nodecache)  { _nodecache = nodecache; /* would like to do "SP_SETATTR (nodecache)" but nodecache is an unordered_map, not some type that derives from a smartpointer. so one day, address this. I'm not sure if it's important though. Anyway I'm phasing out NodeCache in favor of GraphUnitigs. */; }
 
+    /** Create the filter of the deleted nodes, once the node states are set. It is sized
+     * for 4 bits per node, so it answers "not deleted" with one cache line most of the time,
+     * the MPHF being queried only for the nodes the filter finds. */
+    void createDeleted ()
+    {
+        if (_nodestate == NULL)  { setDeleted (0);  return; }
+
+        u_int64_t nbBits = std::max ((u_int64_t)_nodestate->size() * 4, (u_int64_t)512);
+        setDeleted (new tools::collections::impl::BloomBlocked<Type> (nbBits, 3));
+    }
+
     /** Shortcut. */
     bool contains (const Type& item)  const  {  
 
@@ -1253,22 +1272,50 @@ struct GraphData
         if (!res)
             return false;
 
-        /* check if kmer is deleted*/
-        // this is duplicated code from queryNodeState.
-        // NOTE: this does a MPHF query for each bloom contains that answer true. costly!
-        if (_nodestate != NULL)
+        /* check if kmer is deleted; the MPHF is queried only if the kmer may have been deleted. */
+        if (_nodestate != NULL && (_deleted == NULL || _deleted->contains (item)) && isDeleted (item))
+            return false;
+
+        return true;
+    }
+
+    /** Shortcut for many items: the container is queried for all the items at once,
+     * then the filter of deleted nodes, then the deleted state for the remaining items only. */
+    void containsN (const Type* items, size_t n, bool* out)  const  {
+
+        _container->containsN (items, n, out);
+
+        if (_nodestate == NULL)  { return; }
+
+        bool maybeDeleted[DELETED_BATCH_SIZE];
+
+        for (size_t start=0; start<n; start+=DELETED_BATCH_SIZE)
         {
-            unsigned long hashIndex = ((_nodestate))->getCode(item);
-			if(hashIndex == ULLONG_MAX) return false;
-            unsigned char value = ((_nodestate))->at(hashIndex / 2);
-            if ((hashIndex % 2) == 1)
-                value >>= 4;
-            value &= 0xF;
-            if (((value >> 1) & 1) == 1) 
-                return false;
+            size_t nb = std::min ((size_t)DELETED_BATCH_SIZE, n-start);
+
+            if (_deleted != NULL)  {  _deleted->containsN (items+start, nb, maybeDeleted);  }
+            else                   {  std::fill (maybeDeleted, maybeDeleted+nb, true);       }
+
+            for (size_t i=0; i<nb; i++)
+            {
+                if (out[start+i] && maybeDeleted[i] && isDeleted (items[start+i]))  { out[start+i] = false; }
+            }
         }
+    }
 
-        return true;
+    enum { DELETED_BATCH_SIZE = 32 };
+
+    /** Tells whether a kmer is deleted; _nodestate must be set.
+     * This is duplicated code from queryNodeState. */
+    bool isDeleted (const Type& item)  const  {
+
+        unsigned long hashIndex = ((_nodestate))->getCode(item);
+        if(hashIndex == ULLONG_MAX) return true;
+        unsigned char value = ((_nodestate))->at(hashIndex / 2);
+        if ((hashIndex % 2) == 1)
+            value >>= 4;
+        value &= 0xF;
+        return ((value >> 1) & 1) == 1;
     }
 };
 
@@ -283,6 +283,10 @@ void GraphUnitigsTemplate<span>::build_unitigs_postsolid(std::string unitigs_fil
         props->setInt(STR_KMER_SIZE, kmerSize);
 
 
+        /** A snapshot of the previous unitigs would be out of date. */
+        if (System::file().doesExist(unitigs_filename + ".snapshot"))
+            System::file().remove(unitigs_filename + ".snapshot");
+
         UnitigsConstructionAlgorithm<span> unitigs_algo(BaseGraph::getStorage(), unitigs_filename, nb_threads, props, do_bcalm, do_bglue, do_links);
 
         BaseGraph::executeAlgorithm(unitigs_algo, &BaseGraph::getStorage(), props, BaseGraph::_info);
@@ -512,9 +516,27 @@ void GraphUnitigsTemplate<span>::print_unitigs_mem_stats(uint64_t incoming_size,
 }
 
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE : loads the unitigs file (sequences, links, abundances) in memory
+** INPUT   : unitigs_filename, nb_threads (0 for all cores), use_snapshot
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the records are read by chunks; the headers of a chunk are parsed and its sequences
+**           are compressed in parallel, then the chunk is appended in order, so the unitigs ids
+**           are the same as with a sequential loading.
+**           With use_snapshot, a binary snapshot next to the unitigs file is loaded instead when
+**           it is up to date; otherwise it is written after the unitigs file is loaded.
+*********************************************************************/
 template<size_t span>
-void GraphUnitigsTemplate<span>::load_unitigs(string unitigs_filename)
+void GraphUnitigsTemplate<span>::load_unitigs(string unitigs_filename, size_t nb_threads, bool use_snapshot)
 {
+    string snapshot_filename = unitigs_filename + ".snapshot";
+    u_int64_t unitigs_file_size = System::file().getSize(unitigs_filename);
+
+    if (use_snapshot && System::file().doesExist(snapshot_filename) && load_unitigs_snapshot(snapshot_filename, unitigs_file_size))
+        return;
+
     bool verbose = (nb_unitigs > 1000000); // big dataset, let's show some memory usage verbosity here
     if (verbose)
         std::cout << "loading unitigs from disk to memory" << std::endl;
@@ -526,7 +548,7 @@ void GraphUnitigsTemplate<span>::load_unitigs(string unitigs_filename)
     BankFasta::Iterator itSeq (inputBank);
 
     unsigned int kmerSize = BaseGraph::_kmerSize;
-    
+
     //compress_navigational_vectors = false;
     compress_navigational_vectors = true; //only a 10% speed hit but 2x less incoming/outcoming/incoming_map/outcoming_map memory usage, so, quite worth it.
     pack_unitigs = true;
@@ -536,56 +558,87 @@ void GraphUnitigsTemplate<span>::load_unitigs(string unitigs_filename)
     uint64_t nb_utigs_nucl_mem = 0;
     uint64_t total_unitigs_size = 0;
     float incoming_size = 0, outcoming_size = 0;
-    for (itSeq.first(); !itSeq.isDone(); itSeq.next()) // could be done in parallel, maybe, if we used many unordered_map's with a hash on the query kmer (the same opt could be done for LinkTigs)
-    {
-        const string& seq = itSeq->toString();
-        const string& comment = itSeq->getComment();
 
+    /** A unitig record, once parsed by a thread. */
+    struct UnitigRecord
+    {
         float mean_abundance;
         vector<uint64_t> inc, outc; // incoming and outcoming unitigs
-        parse_unitig_header(comment, mean_abundance, inc, outc);
+        string compressed;
+    };
 
-        incoming_size += inc.size();
-        outcoming_size += outc.size();
+    const size_t chunk_size = 100000;
+    vector<string> seqs, comments;
+    vector<UnitigRecord> records;
 
-        if (compress_navigational_vectors) 
-        {
-            // we won't use dag_incoming and dag_outcoming, there doesnt seem to be any performance gain. a bit surprising, though, because i was storing 64bit ints before. but gamma coding is, after all, 2-optimal and most numbers are close to 32 bits.
-            insert_compressed_navigational_vector(/*dag_incoming*/ incoming,  inc,  dag_incoming_map);
-            insert_compressed_navigational_vector(/*dag_outcoming*/ outcoming, outc, dag_outcoming_map);
+    Dispatcher dispatcher (nb_threads);
 
-        }
-        else
+    itSeq.first();
+    while (!itSeq.isDone())
+    {
+        seqs.clear();
+        comments.clear();
+        for ( ; !itSeq.isDone() && seqs.size() < chunk_size; itSeq.next())
         {
-            insert_navigational_vector(incoming,  inc,  incoming_map); // "incoming_map" records the number of incoming links for an unitig. "incoming" records links explicitly
-            insert_navigational_vector(outcoming, outc, outcoming_map);
+            seqs.push_back(itSeq->toString());
+            comments.push_back(itSeq->getComment());
         }
 
-        if (pack_unitigs)
+        records.resize(seqs.size());
+        dispatcher.iterateRange (0, seqs.size(), [&] (u_int64_t i)
         {
-            packed_unitigs += internal_compress_unitig(seq);
-            packed_unitigs_sizes.push_back((seq.size()+3)/4);
-        }
-        else
-            unitigs.push_back(internal_compress_unitig(seq));
+            UnitigRecord& record = records[i];
+            record.mean_abundance = 0;
+            record.inc.clear();
+            record.outc.clear();
+            parse_unitig_header(comments[i], record.mean_abundance, record.inc, record.outc);
+            record.compressed = internal_compress_unitig(seqs[i]);
+        }, 1000);
+
+        for (size_t i = 0; i < seqs.size(); i++)
+        {
+            const string& seq = seqs[i];
+            UnitigRecord& record = records[i];
 
-        unitigs_sizes.push_back(seq.size());
-        total_unitigs_size += seq.size();
-        unitigs_mean_abundance.push_back(mean_abundance);
+            incoming_size += record.inc.size();
+            outcoming_size += record.outc.size();
 
-        //std::cout << "decoded : " << internal_get_unitig_sequence(unitigs.size()-1) << std::endl;
-        //std::cout << "real    : " << seq << std::endl;
+            if (compress_navigational_vectors)
+            {
+                // we won't use dag_incoming and dag_outcoming, there doesnt seem to be any performance gain. a bit surprising, though, because i was storing 64bit ints before. but gamma coding is, after all, 2-optimal and most numbers are close to 32 bits.
+                insert_compressed_navigational_vector(/*dag_incoming*/ incoming,  record.inc,  dag_incoming_map);
+                insert_compressed_navigational_vector(/*dag_outcoming*/ outcoming, record.outc, dag_outcoming_map);
 
-        if (!pack_unitigs)
-        {
-            nb_utigs_nucl += unitigs[unitigs.size()-1].size();
-            nb_utigs_nucl_mem += unitigs[unitigs.size()-1].capacity();
-        }
+            }
+            else
+            {
+                insert_navigational_vector(incoming,  record.inc,  incoming_map); // "incoming_map" records the number of incoming links for an unitig. "incoming" records links explicitly
+                insert_navigational_vector(outcoming, record.outc, outcoming_map);
+            }
 
-        if (seq.size() == kmerSize)
-            nb_unitigs_extremities++;
-        else
-            nb_unitigs_extremities+=2;
+            if (pack_unitigs)
+            {
+                packed_unitigs += record.compressed;
+                packed_unitigs_sizes.push_back((seq.size()+3)/4);
+            }
+            else
+                unitigs.push_back(std::move(record.compressed));
+
+            unitigs_sizes.push_back(seq.size());
+            total_unitigs_size += seq.size();
+            unitigs_mean_abundance.push_back(record.mean_abundance);
+
+            if (!pack_unitigs)
+            {
+                nb_utigs_nucl += unitigs[unitigs.size()-1].size();
+                nb_utigs_nucl_mem += unitigs[unitigs.size()-1].capacity();
+            }
+
+            if (seq.size() == kmerSize)
+                nb_unitigs_extremities++;
+            else
+                nb_unitigs_extremities+=2;
+        }
     }
     nb_unitigs = unitigs_sizes.size();
 
@@ -599,6 +652,168 @@ void GraphUnitigsTemplate<span>::load_unitigs(string unitigs_filename)
     // an estimation of memory usage
     if (verbose)
         print_unitigs_mem_stats(incoming_size, outcoming_size, total_unitigs_size, nb_utigs_nucl, nb_utigs_nucl_mem);
+
+    if (use_snapshot)
+        save_unitigs_snapshot(snapshot_filename, unitigs_file_size);
+}
+
+/* first word of a unitigs snapshot file, followed by its version */
+static const u_int64_t UNITIGS_SNAPSHOT_MAGIC   = 0x5355544741544721ULL;
+static const u_int64_t UNITIGS_SNAPSHOT_VERSION = 1;
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE : saves the unitigs loaded in memory into a binary file
+** INPUT   : filename, unitigs_file_size (size of the unitigs file they were loaded from, used
+**           as a consistency check by load_unitigs_snapshot)
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the snapshot holds the packed sequences, the navigational vectors and the abundances
+**           as raw arrays. The gamma coded vectors (dag_vector) are saved as plain counts. The file
+**           is written under a temporary name and then renamed, so a snapshot is always complete.
+*********************************************************************/
+template<size_t span>
+void GraphUnitigsTemplate<span>::save_unitigs_snapshot(const string& filename, u_int64_t unitigs_file_size) const
+{
+    if (!pack_unitigs)
+        throw system::Exception ("Unitigs snapshot only supports packed unitigs");
+
+    /* number of incoming/outcoming links of each unitig */
+    vector<u_int32_t> nb_incoming(nb_unitigs), nb_outcoming(nb_unitigs);
+    if (compress_navigational_vectors)
+    {
+        if (nb_unitigs > 0)
+        {
+            dag::dag_vector::const_iterator itInc = dag_incoming_map.begin(), itOut = dag_outcoming_map.begin();
+            for (uint64_t i = 0; i < nb_unitigs; i++)
+            {
+                nb_incoming[i] = *itInc;
+                nb_outcoming[i] = *itOut;
+                if (i + 1 < nb_unitigs) { ++itInc; ++itOut; }
+            }
+        }
+    }
+    else
+    {
+        for (uint64_t i = 0; i < nb_unitigs; i++)
+        {
+            nb_incoming[i]  = (i + 1 < nb_unitigs ? incoming_map[i+1]  : incoming.size())  - incoming_map[i];
+            nb_outcoming[i] = (i + 1 < nb_unitigs ? outcoming_map[i+1] : outcoming.size()) - outcoming_map[i];
+        }
+    }
+
+    u_int64_t header[] = { UNITIGS_SNAPSHOT_MAGIC, UNITIGS_SNAPSHOT_VERSION, BaseGraph::_kmerSize, unitigs_file_size,
+        nb_unitigs, nb_unitigs_extremities, compress_navigational_vectors, incoming.size(), outcoming.size(), packed_unitigs.size() };
+
+    string tmp_filename = filename + ".tmp";
+    IFile* file = System::file().newFile (tmp_filename, "wb");
+    if (file == 0)
+        throw system::Exception ("Unable to create unitigs snapshot %s", tmp_filename.c_str());
+
+    bool ok = file->fwrite (header, sizeof(header), 1) == 1
+        && file->fwrite (unitigs_sizes.data(),          sizeof(u_int32_t), nb_unitigs) == nb_unitigs
+        && file->fwrite (unitigs_mean_abundance.data(), sizeof(float),     nb_unitigs) == nb_unitigs
+        && file->fwrite (nb_incoming.data(),            sizeof(u_int32_t), nb_unitigs) == nb_unitigs
+        && file->fwrite (nb_outcoming.data(),           sizeof(u_int32_t), nb_unitigs) == nb_unitigs
+        && file->fwrite (incoming.data(),               sizeof(uint64_t),  incoming.size())  == incoming.size()
+        && file->fwrite (outcoming.data(),              sizeof(uint64_t),  outcoming.size()) == outcoming.size()
+        && file->fwrite (packed_unitigs.data(),         1,                 packed_unitigs.size()) == packed_unitigs.size();
+    delete file;
+
+    if (!ok)
+    {
+        System::file().remove (tmp_filename);
+        throw system::Exception ("Unable to write unitigs snapshot %s", filename.c_str());
+    }
+
+    System::file().rename (tmp_filename, filename);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE : loads the unitigs from a binary file written by save_unitigs_snapshot
+** INPUT   : filename, unitigs_file_size (if not 0, size of the unitigs file the snapshot must
+**           come from)
+** OUTPUT  :
+** RETURN  : false if the snapshot doesn't match the graph kmer size or the unitigs file size
+** REMARKS : the arrays are read as a whole, only the gamma coded vectors are rebuilt.
+*********************************************************************/
+template<size_t span>
+bool GraphUnitigsTemplate<span>::load_unitigs_snapshot(const string& filename, u_int64_t unitigs_file_size)
+{
+    if (!System::file().doesExist(filename))
+        return false;
+
+    IFile* file = System::file().newFile (filename, "rb");
+
+    u_int64_t header[10];
+    if (file->fread (header, sizeof(header), 1) != 1
+        || header[0] != UNITIGS_SNAPSHOT_MAGIC || header[1] != UNITIGS_SNAPSHOT_VERSION
+        || header[2] != BaseGraph::_kmerSize
+        || (unitigs_file_size != 0 && header[3] != unitigs_file_size))
+    {
+        delete file;
+        return false;
+    }
+
+    nb_unitigs                    = header[4];
+    nb_unitigs_extremities        = header[5];
+    compress_navigational_vectors = header[6];
+    pack_unitigs                  = true;
+
+    vector<u_int32_t> nb_incoming(nb_unitigs), nb_outcoming(nb_unitigs);
+    unitigs_sizes.resize(nb_unitigs);
+    unitigs_mean_abundance.resize(nb_unitigs);
+    incoming.resize(header[7]);
+    outcoming.resize(header[8]);
+    packed_unitigs.resize(header[9]);
+
+    bool ok = file->fread (unitigs_sizes.data(),         sizeof(u_int32_t), nb_unitigs) == nb_unitigs
+        && file->fread (unitigs_mean_abundance.data(), sizeof(float),     nb_unitigs) == nb_unitigs
+        && file->fread (nb_incoming.data(),            sizeof(u_int32_t), nb_unitigs) == nb_unitigs
+        && file->fread (nb_outcoming.data(),           sizeof(u_int32_t), nb_unitigs) == nb_unitigs
+        && file->fread (incoming.data(),               sizeof(uint64_t),  incoming.size())  == incoming.size()
+        && file->fread (outcoming.data(),              sizeof(uint64_t),  outcoming.size()) == outcoming.size()
+        && file->fread (&packed_unitigs[0],         1,                 packed_unitigs.size()) == packed_unitigs.size();
+    delete file;
+
+    if (!ok)
+        throw system::Exception ("Truncated unitigs snapshot %s", filename.c_str());
+
+    /* we rebuild the maps of the navigational vectors and the packed unitigs delimiters */
+    dag_incoming_map = dag::dag_vector();
+    dag_outcoming_map = dag::dag_vector();
+    incoming_map.clear();
+    outcoming_map.clear();
+    packed_unitigs_sizes = dag::dag_vector();
+    unitigs.clear();
+
+    uint64_t pos_incoming = 0, pos_outcoming = 0;
+    for (uint64_t i = 0; i < nb_unitigs; i++)
+    {
+        if (compress_navigational_vectors)
+        {
+            dag_incoming_map.push_back(nb_incoming[i]);
+            dag_outcoming_map.push_back(nb_outcoming[i]);
+        }
+        else
+        {
+            incoming_map.push_back(pos_incoming);
+            outcoming_map.push_back(pos_outcoming);
+        }
+        pos_incoming += nb_incoming[i];
+        pos_outcoming += nb_outcoming[i];
+
+        packed_unitigs_sizes.push_back((unitigs_sizes[i]+3)/4);
+    }
+
+    unitigs_traversed.resize(0);
+    unitigs_traversed.resize(nb_unitigs, false);
+
+    unitigs_deleted.resize(0);
+    unitigs_deleted.resize(nb_unitigs, false);
+
+    return true;
 }
 
 //https://stackoverflow.com/questions/216823/whats-the-best-way-to-trim-stdstring
@@ -918,7 +1133,7 @@ GraphUnitigsTemplate<span>::GraphUnitigsTemplate (tools::misc::IProperties* para
         //BaseGraph::setStorage (StorageFactory(BaseGraph::_storageMode).create (input, false, false));
 
         if (load_unitigs_after) 
-            load_unitigs(unitigs_filename);
+            load_unitigs(unitigs_filename, params->getInt(STR_NB_CORES), params->get("-unitigs-snapshot") != 0);
 
     }
     else
@@ -939,7 +1154,7 @@ GraphUnitigsTemplate<span>::GraphUnitigsTemplate (tools::misc::IProperties* para
         build_unitigs_postsolid(unitigs_filename, params);
         
         if (load_unitigs_after)
-            load_unitigs(unitigs_filename);
+            load_unitigs(unitigs_filename, params->getInt(STR_NB_CORES), params->get("-unitigs-snapshot") != 0);
     }
 }
 
@@ -2074,14 +2289,11 @@ template<size_t span>
 std::string GraphUnitigsTemplate<span>::internal_compress_unitig(std::string seq) const
 {
     unsigned int n = (seq.size()+3)/4;
-    unsigned char res[n];
-    for (size_t i = 0; i < n; i++)
-        res[i] = 0;
+    std::string res_str(n, 0); // not on the stack, since it's also called by the loading threads
 
     for (size_t i = 0; i < seq.size(); i++)
-        res[i / 4] |= ((seq[i] >> 1) & 3) << (2*(i % 4));
+        res_str[i / 4] |= ((seq[i] >> 1) & 3) << (2*(i % 4));
     
-    std::string res_str(reinterpret_cast<const char *>(res), n);
     return res_str;
 }
 
@@ -396,7 +396,11 @@ public: // was private: before, but had many compilation errors during the chang
     typedef typename gatb::core::kmer::impl::Kmer<span>::Type           Type;
 
     void build_unitigs_postsolid(std::string unitigs_filename, tools::misc::IProperties* props);
-    void load_unitigs(std::string unitigs_filename);
+    void load_unitigs(std::string unitigs_filename, size_t nb_threads = 0, bool use_snapshot = false);
+
+    // binary snapshot of the unitigs loaded in memory, see load_unitigs
+    void save_unitigs_snapshot(const std::string& filename, u_int64_t unitigs_file_size = 0) const;
+    bool load_unitigs_snapshot(const std::string& filename, u_int64_t unitigs_file_size = 0);
 
     void load_unitigs_from_gfa(std::string gfa_filename, unsigned int& kmerSize);
     void print_unitigs_mem_stats(uint64_t avg_incoming_size, uint64_t avg_outcoming_size, uint64_t total_unitigs_size, uint64_t nb_utigs_nucl = 0, uint64_t nb_utigs_nucl_mem = 0);
@@ -423,7 +423,7 @@ unsigned long Simplifications<GraphType,Node,Edge>::removeTips()
     // nodes deleter stuff
     NodesDeleter<Node,Edge,GraphType> nodesDeleter(_graph, nbNodes, _nbCores, _verbose);
 
-    dispatcher.iterate (*itNode, [&] (Node& node)
+    dispatcher.iterateSplit (itNode, [&] (Node& node)
     {
          /* just a quick note, which was observed in the context of flagging some node as uninteresting (not used anymore).
           * property: "a tip (detected at some point after some rounds of simplifications) is not necessarily a branching node initially in the original graph"
@@ -1324,7 +1324,7 @@ unsigned long Simplifications<GraphType,Node,Edge>::removeBulges()
     NodesDeleter<Node,Edge,GraphType> nodesDeleter(_graph, nbNodes, _nbCores, _verbose);
 
 #ifdef SIMPLIFICATION_LAMBDAS 
-    dispatcher.iterate (itNode, [&] (Node& node) {
+    dispatcher.iterateSplit (itNode, [&] (Node& node) {
 #else
     for (itNode->first(); !itNode->isDone(); itNode->next())
     {
@@ -1647,7 +1647,7 @@ unsigned long Simplifications<GraphType,Node,Edge>::removeErroneousConnections()
     NodesDeleter<Node,Edge,GraphType> nodesDeleter(_graph, nbNodes, _nbCores, _verbose);
 
 #ifdef SIMPLIFICATION_LAMBDAS 
-    dispatcher.iterate (itNode, [&] (Node& node) {
+    dispatcher.iterateSplit (itNode, [&] (Node& node) {
 #else
     for (itNode->first(); !itNode->isDone(); itNode->next())
     {
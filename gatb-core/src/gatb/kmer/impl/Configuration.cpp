@@ -81,6 +81,11 @@ Properties Configuration::getProperties() const
     result.add (1, "nb_cores",          "%d",  _nbCores);
     result.add (1, "minimizer_type",    "%s",  (_minimizerType == 0) ? "lexicographic (kmc2 heuristic)" : "frequency");
     result.add (1, "repartition_type",  "%s",  (_repartitionType == 0) ? "unordered" : "ordered");
+    result.add (1, "partition_sort",    "%s",  toString(_partitionSort).c_str());
+    result.add (1, "pipeline_passes",   "%d",  _pipelinePasses);
+    result.add (1, "in_memory_partitions", "%d", _inMemoryPartitions);
+    result.add (1, "compress_partitions", "%d", _compressPartitions);
+    result.add (1, "async_writes",      "%d",  _asyncWrites);
 
     result.add (1, "nb_cores_per_partition",     "%d",  _nbCores_per_partition);
     result.add (1, "nb_partitions_in_parallel",  "%d",  _nb_partitions_in_parallel);
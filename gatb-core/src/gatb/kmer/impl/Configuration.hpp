@@ -42,12 +42,12 @@ public:
     /** */
     Configuration ()
     : _kmerSize(0), _minim_size(0), _repartitionType(0), _minimizerType(0),
-      _solidityKind(tools::misc::KMER_SOLIDITY_SUM),
+      _solidityKind(tools::misc::KMER_SOLIDITY_SUM), _partitionSort(tools::misc::PARTITION_SORT_RADIX), _pipelinePasses(false), _diskPartitions(false), _compressPartitions(false), _asyncWrites(false),
       _max_disk_space(0), _max_memory(0),
       _nbCores(0), _nb_partitions_in_parallel(0), _abundanceUserNb(0), _storage_type(tools::storage::impl::STORAGE_HDF5) ,
       _isComputed(false), _nbCores_per_partition(0),
       _estimateSeqNb(0), _estimateSeqTotalSize(0), _estimateSeqMaxSize(0),
-      _available_space(0), _volume(0), _kmersNb(0), _nb_passes(0), _nb_partitions(0), _nb_bits_per_kmer(0), _nb_banks(0) {}
+      _available_space(0), _volume(0), _kmersNb(0), _nb_passes(0), _nb_partitions(0), _nb_bits_per_kmer(0), _nb_banks(0), _inMemoryPartitions(false) {}
 
     /****************************************/
     /**             PROVIDED                */
@@ -60,6 +60,20 @@ public:
 
     tools::misc::KmerSolidityKind _solidityKind;
 
+    tools::misc::PartitionSortKind _partitionSort;
+
+    /** Count the partitions of a pass while the partitions of the next pass are filled. */
+    bool        _pipelinePasses;
+
+    /** Always write the superkmers partitions into temporary files, even for small inputs. */
+    bool        _diskPartitions;
+
+    /** Compress the superkmers partitions, which needs less disk space and so less passes. */
+    bool        _compressPartitions;
+
+    /** Write the superkmers partitions from a dedicated thread instead of the filling threads. */
+    bool        _asyncWrites;
+
     u_int64_t   _max_disk_space;
     u_int32_t   _max_memory;
 
@@ -99,10 +113,34 @@ public:
     
     u_int32_t   _nb_cached_items_per_core_per_part;
 
+    /** The superkmers partitions of the (single) pass are kept in RAM buffers instead of temporary files. */
+    bool        _inMemoryPartitions;
+
 
     /****************************************/
     /**               MISC                  */
     /****************************************/
+
+    /** Get the memory (in MBytes) for counting the partitions of a pass. In pipelined mode,
+     * a part of the memory is kept for the partitions cache of the pass filled meanwhile.
+     * \return the memory size. */
+    u_int32_t getCountMemory () const
+    {
+        if (_pipelinePasses)      {  return _max_memory - _max_memory/PIPELINE_FILL_MEMORY_RATIO;  }
+        if (_inMemoryPartitions)  {  return _max_memory - _max_memory/IN_MEMORY_PARTITIONS_RATIO;  }
+        return _max_memory;
+    }
+
+    /** In pipelined mode, 1/PIPELINE_FILL_MEMORY_RATIO of the memory is kept for filling partitions. */
+    static const u_int32_t PIPELINE_FILL_MEMORY_RATIO = 5;
+
+    /** Partitions are kept in memory when their estimated volume is less than 1/IN_MEMORY_PARTITIONS_RATIO of the memory. */
+    static const u_int32_t IN_MEMORY_PARTITIONS_RATIO = 2;
+
+    /** Expected size of compressed superkmers partitions, in percent of their raw size (rather
+     * 85% for reads without much redundancy, so we keep some margin for the disk space). */
+    static const u_int32_t COMPRESSED_PARTITIONS_PERCENT = 90;
+
     tools::misc::impl::Properties getProperties() const;
 
     /** Load config properties from a storage object.
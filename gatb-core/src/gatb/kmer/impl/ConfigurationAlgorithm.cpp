@@ -199,6 +199,13 @@ ConfigurationAlgorithm<span>::ConfigurationAlgorithm (bank::IBank* bank, IProper
 
     parse (input->getStr (STR_SOLIDITY_KIND), _config._solidityKind);
 
+    if (input->get(STR_PARTITION_SORT))  {  parse (input->getStr (STR_PARTITION_SORT), _config._partitionSort);  }
+
+    _config._pipelinePasses     = input->get(STR_PIPELINE_PASSES) != 0;
+    _config._diskPartitions     = input->get(STR_DISK_PARTITIONS) != 0;
+    _config._compressPartitions = input->get(STR_COMPRESS_PARTITIONS) != 0;
+    _config._asyncWrites        = input->get(STR_ASYNC_WRITES) != 0;
+
     _config._max_disk_space     = input->getInt (STR_MAX_DISK);
     _config._max_memory         = input->getInt (STR_MAX_MEMORY);
     _config._nbCores            = input->get(STR_NB_CORES) ? input->getInt(STR_NB_CORES) : 0;
@@ -337,7 +344,31 @@ void ConfigurationAlgorithm<span>::execute ()
 
     assert (_config._max_disk_space > 0);
 
-    _config._nb_passes = ( (_config._volume/4) / _config._max_disk_space ) + 1; //minim, approx volume /switched to approx /4 (was/3) because of more efficient superk storage
+    /** Only superkmers partitions (ie. 'sum' solidity) may be compressed; we expect them to be smaller then. */
+    if (_config._solidityKind != KMER_SOLIDITY_SUM)  {  _config._compressPartitions = false;  }
+
+    u_int64_t volume_superk = _config._volume/4;
+    if (_config._compressPartitions)  {  volume_superk = volume_superk * Configuration::COMPRESSED_PARTITIONS_PERCENT / 100;  }
+
+    _config._nb_passes = ( volume_superk / _config._max_disk_space ) + 1; //minim, approx volume /switched to approx /4 (was/3) because of more efficient superk storage
+
+    /** Pipelining only makes sense with several passes, and is done for superkmers partitions (ie. 'sum' solidity).
+     * Since the files of two passes are on disk at the same time, each pass gets half of the disk space. */
+    if (_config._pipelinePasses)
+    {
+        if (_config._nb_passes > 1 && _config._solidityKind == KMER_SOLIDITY_SUM)
+        {
+            _config._nb_passes = ( volume_superk / std::max ((u_int64_t)1, _config._max_disk_space/2) ) + 1;
+        }
+        else  {  _config._pipelinePasses = false;  }
+    }
+
+    /** A single pass whose superkmers (estimated as for the disk space) fit in a part of the memory
+     * is counted from RAM buffers, without creating temporary partition files. */
+    _config._inMemoryPartitions = !_config._diskPartitions
+        && _config._solidityKind == KMER_SOLIDITY_SUM
+        && _config._nb_passes    == 1
+        && volume_superk < _config._max_memory / Configuration::IN_MEMORY_PARTITIONS_RATIO;
     //_nb_passes = 1; //do not constrain nb passes on disk space anymore (anyway with minim, not very big)
     //increase it only if ram issue
 
@@ -395,18 +426,21 @@ void ConfigurationAlgorithm<span>::execute ()
         //printf("volume_per_pass %lli  _nbCores %zu _max_memory %i \n",volume_per_pass, _nbCores,_max_memory);
 
         // _nb_partitions  = ( (volume_per_pass*_nbCores) / _max_memory ) + 1;
-        _config._nb_partitions  = ( ( volume_per_pass* _config._nb_partitions_in_parallel) / _config._max_memory ) + 1;
+        _config._nb_partitions  = ( ( volume_per_pass* _config._nb_partitions_in_parallel) / _config.getCountMemory() ) + 1;
 
         //printf("nb passes  %i  (nb part %i / %zu)\n",_nb_passes,_nb_partitions,max_open_files);
         //_nb_partitions = max_open_files; break;
 
         if (_config._nb_partitions >= max_open_files && _config._nb_partitions_in_parallel >1)     { _config._nb_partitions_in_parallel  = _config._nb_partitions_in_parallel /2;  }
-        else if (_config._nb_partitions >= max_open_files && _config._nb_partitions_in_parallel == 1)   { _config._nb_passes++;  }
+        else if (_config._nb_partitions >= max_open_files && _config._nb_partitions_in_parallel == 1)   { _config._nb_passes++;  _config._inMemoryPartitions = false;  }
         else                                                                            { break;         }
 
         //printf("update nb passes  %i  (nb part %i / %zu)\n",_nb_passes,_nb_partitions,max_open_files);
     } while (1);
 
+    /** The writer thread is only useful for superkmers partitions files. */
+    if (_config._inMemoryPartitions || _config._solidityKind != KMER_SOLIDITY_SUM)  {  _config._asyncWrites = false;  }
+
     //if (_config._nb_partitions < 50 &&  (max_open_files - _config._nb_partitions  > 30) ) _config._nb_partitions += 30; //a hack to have more partitions than 30
 
     //round nb parti to upper multiple of _nb_partitions_in_parallel if possible
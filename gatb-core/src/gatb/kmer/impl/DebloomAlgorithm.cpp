@@ -181,8 +181,8 @@ IOptionsParser* DebloomAlgorithm<span>::getOptionsParser ()
 {
     IOptionsParser* parser = new OptionsParser ("bloom");
 
-    parser->push_back (new OptionOneParam (STR_BLOOM_TYPE,        "bloom type ('basic', 'cache', 'neighbor')",false, "neighbor"));
-    parser->push_back (new OptionOneParam (STR_DEBLOOM_TYPE,      "debloom type ('none', 'original' or 'cascading')", false, "cascading"));
+    parser->push_back (new OptionOneParam (STR_BLOOM_TYPE,        "bloom type ('basic', 'cache', 'neighbor', 'blocked')",false, "neighbor"));
+    parser->push_back (new OptionOneParam (STR_DEBLOOM_TYPE,      "debloom type ('none', 'original', 'cascading' or 'quotient')", false, "cascading"));
     parser->push_back (new OptionOneParam (STR_DEBLOOM_IMPL,      "debloom impl ('basic', 'minimizer')",      false, "minimizer"));
 
     return parser;
@@ -208,7 +208,11 @@ void DebloomAlgorithm<span>::execute ()
     u_int64_t totalSizeCFP = 0;
 
     /** We execute the debloom if needed. */
-    if (_debloomKind != DEBLOOM_NONE)
+    if (_debloomKind == DEBLOOM_QUOTIENT)
+    {
+        execute_quotient (cfpProps, totalSizeCFP);
+    }
+    else if (_debloomKind != DEBLOOM_NONE)
     {
         execute_aux (bloomProps, cfpProps, totalSizeBloom, totalSizeCFP);
     }
@@ -230,6 +234,48 @@ void DebloomAlgorithm<span>::execute ()
     _groupDebloom.addProperty ("kind", toString(_debloomKind));
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the Bloom filter is not needed here; the filter is sized for the solid kmers,
+**           so it is not resized during the insertions.
+*********************************************************************/
+template<size_t span>
+void DebloomAlgorithm<span>::execute_quotient (
+    IProperties* cfpProps,
+    u_int64_t&   totalSizeCFP
+)
+{
+    QuotientFilter<Type>* filter = new QuotientFilter<Type> (QuotientFilter<Type>::computeQuotientBits (_solidIterable->getNbItems()));
+    LOCAL (filter);
+
+    /** We insert the solid kmers with their abundance. */
+    Iterator<Count>* it = createIterator<Count> (
+        _solidIterable->iterator(),
+        _solidIterable->getNbItems(),
+        progressFormat6()
+    );
+    LOCAL (it);
+
+    {   TIME_INFO (getTimeInfo(), "build_quotient");
+
+        for (it->first(); !it->isDone(); it->next())  {  filter->add (it->item().value, it->item().abundance);  }
+    }
+
+    /** We save the filter into the storage. */
+    StorageTools::singleton().saveQuotientFilter<Type> (_groupDebloom, "quotient", filter);
+
+    totalSizeCFP = 8*filter->getSize();
+
+    cfpProps->add (1, "quotient_bits",  "%ld", filter->getQuotientBits());
+    cfpProps->add (1, "remainder_bits", "%ld", filter->getRemainderBits());
+    cfpProps->add (1, "load",           "%.3f", filter->getLoad());
+    cfpProps->add (1, "size",           "%ld", totalSizeCFP);
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -288,11 +334,16 @@ void DebloomAlgorithm<span>::execute_aux (
         /** We iterate the solid kmers. */
         getDispatcher()->iterate (itKmers, [&] (const Count& kmer)
         {
-            /** We iterate the neighbors of the current solid kmer. */
-            model.iterateNeighbors (kmer.value, [&] (const Type& k)
-            {
-                if (bloom->contains (k))  {  extendBag().insert (k);  }
-            });
+            /** We get the neighbors of the current solid kmer. */
+            Type   neighbors[8];
+            bool   found[8];
+            size_t nbNeighbors = 0;
+            model.iterateNeighbors (kmer.value, [&] (const Type& k)  {  neighbors[nbNeighbors++] = k;  });
+
+            /** We query the Bloom filter for all of them at once. */
+            bloom->containsN (neighbors, nbNeighbors, found);
+
+            for (size_t i=0; i<nbNeighbors; i++)  {  if (found[i])  {  extendBag().insert (neighbors[i]);  }  }
         });
 
         /** We have to flush each bag cache used during iteration. */
@@ -646,6 +697,26 @@ float DebloomAlgorithm<span>::getNbBitsPerKmer (size_t kmerSize, DebloomKind deb
     return nbitsPerKmer;
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : a blocked Bloom filter has more false positives than the other kinds for
+**           the same size (its blocks are not evenly filled); we compensate with 0.5% more
+**           bits for each bit per kmer, which gives about the same false positive rate.
+*********************************************************************/
+template<size_t span>
+float DebloomAlgorithm<span>::getNbBitsPerKmer (size_t kmerSize, DebloomKind debloomKind, BloomKind bloomKind)
+{
+    float nbitsPerKmer = getNbBitsPerKmer (kmerSize, debloomKind);
+
+    if (bloomKind == BLOOM_BLOCKED)  {  nbitsPerKmer *= 1 + nbitsPerKmer/200;  }
+
+    return nbitsPerKmer;
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -683,6 +754,14 @@ void DebloomAlgorithm<span>::loadDebloomStructures ()
             break;
         }
 
+        case DEBLOOM_QUOTIENT:
+        {
+            QuotientFilter<Type>* filter = StorageTools::singleton().loadQuotientFilter<Type> (_groupDebloom, "quotient");
+
+            setDebloomStructures (new debruijn::impl::ContainerNodeQuotient<Type> (filter));
+            break;
+        }
+
         case DEBLOOM_CASCADING:
         {
             IBloom<Type>*     bloom   = StorageTools::singleton().loadBloom<Type>     (_groupBloom,   "bloom");
@@ -136,6 +136,13 @@ public:
      * \return number of bits per kmer. */
     static float getNbBitsPerKmer (size_t kmerSize, tools::misc::DebloomKind debloomKind);
 
+    /** Get the number of bits per kmer for a given kind of Bloom filter
+     * \param[in] kmerSize : kmer size
+     * \param[in] debloomKind : kind of debloom
+     * \param[in] bloomKind : kind of Bloom filter
+     * \return number of bits per kmer. */
+    static float getNbBitsPerKmer (size_t kmerSize, tools::misc::DebloomKind debloomKind, tools::misc::BloomKind bloomKind);
+
     /** Get the class name (for statistics output).
      * \return the class name. */
     virtual const char* getClassName() const { return "DebloomAlgorithm"; }
@@ -150,6 +157,12 @@ protected:
         u_int64_t& totalSizeCFP
     );
 
+    /** Build the quotient filter of the solid kmers (instead of the Bloom filter and the cFP). */
+    void execute_quotient (
+        tools::misc::IProperties* cfpProps,
+        u_int64_t& totalSizeCFP
+    );
+
     /** */
     virtual gatb::core::tools::collections::impl::IBloom<Type>* createBloom (
         tools::collections::Iterable<Count>* solidIterable,
@@ -201,6 +214,7 @@ protected:
     static const char* progressFormat3() { return "Debloom: finalization                  "; }
     static const char* progressFormat4() { return "Debloom: cascading                     "; }
     static const char* progressFormat5() { return "Debloom: save                          "; }
+    static const char* progressFormat6() { return "Debloom: quotient filter               "; }
 };
 
 /********************************************************************************/
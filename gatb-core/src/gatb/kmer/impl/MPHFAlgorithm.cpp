@@ -231,28 +231,29 @@ void MPHFAlgorithm<span,Abundance_t,NodeState_t>::populate ()
     itKmers->addObserver (_progress);
     LOCAL (itKmers);
 
-    // TODO parallize that
-
 	std::vector<int> & _abundanceDiscretization =  _abundanceMap->_abundanceDiscretization ;
 	int max_abundance_discrete = _abundanceDiscretization[_abundanceDiscretization.size()-2];
-    // set counts and at the same time, test the mphf
-    for (itKmers->first(); !itKmers->isDone(); itKmers->next())
+
+    /** We count per thread the iterated kmers and the kmers whose abundance is clipped. */
+    ThreadObject<pair<size_t,size_t> > counts;
+
+    /** We set the counts and at the same time, we test the mphf. The partitions of the solid kmers are
+     * read concurrently (see IDispatcher::iterateSplit); each kmer has its own slot in the map, so the
+     * threads never write at the same place. */
+    getDispatcher()->iterateSplit (itKmers, [&] (const Count& kmer)
     {
-        //cout << "kmer: " << itKmers->item().value.toString(21) << std::endl;
-        
         /** We get the hash code of the current item. */
-        typename AbundanceMap::Hash::Code h = _abundanceMap->getCode (itKmers->item().value);
+        typename AbundanceMap::Hash::Code h = _abundanceMap->getCode (kmer.value);
 
         /** Little check. */
         if (h >= n) {  throw Exception ("MPHF check: value out of bounds"); }
 
         /** We get the abundance of the current kmer. */
-        int abundance = itKmers->item().abundance;
+        int abundance = kmer.abundance;
 
         if (abundance > max_abundance_discrete)
         {
-            _nb_abundances_above_precision++;
-            //std::cout << "found abundance larger than discrete: " << abundance << std::endl;
+            counts().second ++;
             abundance = max_abundance_discrete;
         }
 
@@ -263,8 +264,14 @@ void MPHFAlgorithm<span,Abundance_t,NodeState_t>::populate ()
         /** We set the abundance of the current kmer. */
         _abundanceMap->at (h) = idx;
 
-        nb_iterated ++;
-    }
+        counts().first ++;
+    });
+
+    counts.foreach ([&] (const pair<size_t,size_t>& c)
+    {
+        nb_iterated                    += c.first;
+        _nb_abundances_above_precision += c.second;
+    });
 
     if (nb_iterated != n && n > 3)
     {
@@ -300,15 +307,14 @@ void MPHFAlgorithm<span,Abundance_t,NodeState_t>::check ()
     size_t nb_iterated = 0;
 
     Iterator<Count>* itKmers = _solidCounts->iterator();  LOCAL (itKmers);
-    
-    // TODO parallize that too
 
-    for (itKmers->first(); !itKmers->isDone(); itKmers->next())
-    {
-        Count& count = itKmers->item();
+    ThreadObject<size_t> counts;
 
+    getDispatcher()->iterateSplit (itKmers, [&] (const Count& count)
+    {
         /** We get the current abundance. */
         Abundance_t abundance = (*_abundanceMap)[count.value];
+        (void) abundance;
 
         // sanity check (thank god i wrote this, was useful for spruce) //todo change this now that abundance is discretized
        /* if (abundance!=count.abundance && abundance<MAX_ABUNDANCE)
@@ -320,8 +326,10 @@ void MPHFAlgorithm<span,Abundance_t,NodeState_t>::check ()
             throw Exception ("ERROR: MPHF isn't injective (abundance population failed)");  
         }*/
 
-        nb_iterated ++;
-    }
+        counts() ++;
+    });
+
+    counts.foreach ([&] (size_t c)  {  nb_iterated += c;  });
 
     if (nb_iterated != _abundanceMap->size() && _abundanceMap->size() > 3)
     {
@@ -182,16 +182,6 @@ struct Kmer
         Type _value;
         bool _isValid;
         friend class ModelDirect;
-
-        /** Extract a mmer from a kmer. This is done by using a mask on the kmer.
-         * \param[in] mask : mask to be applied to the current kmer
-         * \param[in] size : shift size (needed for some kmer classes but not all)
-         * \param[in] mmer_lut : lookup table of minimizers
-         * \return the extracted kmer.
-         */
-
-        KmerDirect extract      (const Type& mask, size_t size, Type * mmer_lut)  {  KmerDirect output;  output.set (mmer_lut[(this->value() & mask).getVal()]);  return output;  }
-        KmerDirect extractShift (const Type& mask, size_t size, Type * mmer_lut)  {  KmerDirect output = extract(mask,size,mmer_lut);  _value = _value >> 2;  return output;  }
     };
 
     /** \brief Kmer type for the ModelCanonical class.
@@ -293,33 +283,6 @@ struct Kmer
         bool _isValid;
         void updateChoice () { choice = (table[0] < table[1]) ? 0 : 1; }
         friend class ModelCanonical;
-
-        /** Extract a mmer from a kmer. This is done by using a mask on the kmer.
-         * \param[in] mask : mask to be applied to the current kmer
-         * \param[in] size : shift size (needed for some kmer classes but not all)
-         * \param[in] mmer_lut : lookup table of minimizers
-         * \return the extracted kmer.
-         */
-        KmerCanonical extract (const Type& mask, size_t size, Type* mmer_lut)
-        {
-
-            KmerCanonical output;
-			
-			output.set(mmer_lut[(this->table[0] & mask).getVal()]); //no need to recomp updateChoice with this
-			//mmer_lut takes care of revcomp and forbidden mmers
-			//output.set (this->table[0] & mask, (this->table[1] >> size) & mask);
-            //output.updateChoice();
-            return output;
-        }
-
-
-        KmerCanonical extractShift (const Type& mask, size_t size, Type * mmer_lut)
-        {
-            KmerCanonical output = extract (mask, size,mmer_lut);
-            table[0] = table[0] >> 2;   table[1] = table[1] << 2;  updateChoice();
-            return output;
-        }
-       
      };
 
     /** \brief Kmer type for the ModelMinimizer class.
@@ -512,6 +475,22 @@ struct Kmer
             return true;
         }
 
+        /** Build the successive kmers of a Data object in one go. The nucleotides are converted by chunks
+         * (with SIMD for ASCII data), then the forward, reverse complement and canonical values of the kmers
+         * are written in buffers provided by the caller; a null buffer is not filled. As with 'iterate',
+         * a bad nucleotide (N for instance) is taken as a G and the kmers holding it are invalid: they are
+         * flagged in the 'invalid' bitmap (bit i%64 of the word i/64 for the kmer i).
+         * \param[in] data : the sequence of nucleotides.
+         * \param[out] forward : buffer of (at least) data.size()-kmerSize+1 forward kmers, or null
+         * \param[out] revcomp : buffer of reverse complement kmers, or null
+         * \param[out] canonical : buffer of canonical kmers, or null
+         * \param[out] invalid : bitmap of (data.size()-kmerSize+64)/64 words, or null
+         * \return the number of kmers, 0 if the data is shorter than a kmer. */
+        size_t buildBatch (tools::misc::Data& data, Type* forward, Type* revcomp, Type* canonical, u_int64_t* invalid=0)  const
+        {
+            return execute <Functor_buildBatch> (data.getEncoding(), Functor_buildBatch(data, forward, revcomp, canonical, invalid));
+        }
+
         /** Iterate the neighbors of a given kmer; these neighbors are:
          *  - 4 outgoing neighbors (with nt A,C,T,G)
          *  - 4 incoming neighbors (with nt A,C,T,G)
@@ -767,6 +746,64 @@ struct Kmer
         template <class Callcack>
         void  notification (const Kmer& value, size_t idx, Callcack callback) const {  callback (value, idx);  }
 
+        /* Adaptor between the 'execute' method and the 'buildBatch' method. */
+        struct Functor_buildBatch
+        {
+            typedef size_t Result;
+            tools::misc::Data& data;  Type* forward;  Type* revcomp;  Type* canonical;  u_int64_t* invalid;
+            Functor_buildBatch (tools::misc::Data& data, Type* forward, Type* revcomp, Type* canonical, u_int64_t* invalid)
+                : data(data), forward(forward), revcomp(revcomp), canonical(canonical), invalid(invalid) {}
+            template<class Convert>  Result operator() (const ModelAbstract* model)
+            {
+                return model->template buildBatch<Convert> (data.getBuffer(), data.size(), forward, revcomp, canonical, invalid);
+            }
+        };
+
+        /** Template method for the buildBatch method: the nucleotides are converted 64 at a time
+         * in a local buffer, then the kmers are rolled over the converted nucleotides. */
+        template<typename Convert>
+        size_t buildBatch (const char* seq, size_t length, Type* forward, Type* revcomp, Type* canonical, u_int64_t* invalid) const
+        {
+            if (length < _kmerSize)  { return 0; }
+
+            size_t nbKmers = length - _kmerSize + 1;
+            if (invalid != 0)  {  memset (invalid, 0, ((nbKmers+63)/64) * sizeof(u_int64_t));  }
+
+            char codes[64];
+            Type fw;  fw.setVal(0);
+            Type rc;  rc.setVal(0);
+
+            /** A kmer ending at a position lower than 'firstValid' holds a bad nucleotide. */
+            size_t firstValid = 0;
+
+            for (size_t chunk=0; chunk<length; chunk+=64)
+            {
+                size_t    nb  = std::min ((size_t)64, length-chunk);
+                u_int64_t bad = Convert::getChunk (seq, chunk, nb, codes);
+
+                for (size_t i=0; i<nb; i++)
+                {
+                    size_t pos = chunk + i;
+                    int    c   = codes[i];
+
+                    fw = ((fw << 2) + c)                   & _kmerMask;
+                    rc = ((rc >> 2) + _revcompTable[c])    & _kmerMask;
+
+                    if ((bad >> i) & 1)  {  firstValid = pos + _kmerSize;  }
+
+                    if (pos+1 < _kmerSize)  { continue; }
+
+                    size_t idx = pos + 1 - _kmerSize;
+                    if (forward   != 0)  { forward[idx]   = fw; }
+                    if (revcomp   != 0)  { revcomp[idx]   = rc; }
+                    if (canonical != 0)  { canonical[idx] = std::min (fw, rc); }
+                    if (invalid   != 0 && pos < firstValid)  {  invalid[idx>>6] |= (u_int64_t)1 << (idx & 63);  }
+                }
+            }
+
+            return nbKmers;
+        }
+
         /** */
         template<typename Type>
         struct BuildFunctor
@@ -1012,6 +1049,7 @@ struct Kmer
               _kmerModel(kmerSize), _miniModel(minimizerSize), _cmp(cmp), _freq_order(freq_order)
         {
             if (kmerSize < minimizerSize)  { throw system::Exception ("Bad values for kmer %d and minimizer %d", kmerSize, minimizerSize); }
+            if (minimizerSize > 31)        { throw system::Exception ("Bad value for minimizer %d (max is 31)", minimizerSize); }
 
             _minimizerSize = minimizerSize;
 			
@@ -1021,60 +1059,24 @@ struct Kmer
             /** We need a mask to extract a mmer from a kmer. */
 
             _mask.setVal(((u_int64_t)1 << (2*_minimizerSize)) - 1);
-            _shift = 2*(_nbMinimizers-1);
 
             /** We initialize the default value of the minimizer.
              * The value is actually set by the Comparator instance provided as a template of the class. */
             Type tmp;
             _cmp.template init<ModelType> (getMmersModel(), tmp);
             _minimizerDefault.set (tmp); //////////max value of minim
-			
-			u_int64_t nbminims_total = ((u_int64_t)1 << (2*_minimizerSize));
-			_mmer_lut = (Type *) MALLOC(sizeof(Type) * nbminims_total ); //free that in destructor
-                
+
             /* if it's ModelDirect, don't do a revcomp; also, use slow method */
             ModelCanonical* isModelCanonical_p = dynamic_cast<ModelCanonical*>(&_kmerModel);
             bool isModelCanonical = isModelCanonical_p != NULL;
             _defaultFast = isModelCanonical;
 
-			for(u_int64_t ii=0; ii< nbminims_total; ii++)
-			{
-				Type mmer;
-				mmer.setVal(ii);
-				
-				// if(!is_allowed(mmer.getVal(),minimizerSize)) mmer = _mask;
-				// if(!is_allowed(rev_mmer.getVal(),minimizerSize)) rev_mmer = _mask;
-				
-				if (isModelCanonical)
-				{
-					Type rev_mmer = revcomp(mmer, minimizerSize);
-					if(rev_mmer < mmer) mmer = rev_mmer;
-					
-					//may be cleaner with this
-					//if (_cmp (rev_mmer, mmer ) == true)
-					//	mmer = rev_mmer;
-				}
-				
-				//std:: cout << "ii " << ii << " is allowed " << is_allowed(mmer.getVal(),minimizerSize) <<  " mmer getval " << mmer.getVal() << " is model canonical " << isModelCanonical << std::endl;
-				
-				if (!is_allowed(mmer.getVal(),minimizerSize))
-					mmer = _mask;
-				
-				_mmer_lut[ii] = mmer;
-			}
+            /** The mmers are normalized on the fly (revcomp, forbidden mmers) by the minimizer window;
+             * every minimizer is allowed in freq order. */
+            _window = MinimizerWindow (_minimizerSize, isModelCanonical, freq_order==NULL);
 
             if (freq_order)
                 setMinimizersFrequency(freq_order);
-
-			
-        }
-
-
-
-        /** Destructor */
-        ~ModelMinimizer ()
-        {
-            if (_mmer_lut != 0)  { FREE (_mmer_lut); }
         }
 
         /** Computes a kmer from a buffer holding nucleotides encoded in some format.
@@ -1112,8 +1114,9 @@ struct Kmer
             /** We set the valid status according to the Convert result. */
             kmer._isValid = isValid;
 
-            /** We extract the new mmer from the kmer. also applies the mmer_lut */
-            typename ModelType::Kmer mmer = kmer.extract (this->_mask, this->_shift,_mmer_lut);
+            /** We extract the new mmer from the kmer (in its canonical or forbidden form). */
+            Type mmer;
+            mmer.setVal (_window.normalize (kmer.value(0).getVal() & _mask.getVal()));
 
             /** We update the position of the previous minimizer. */
             kmer._position--;
@@ -1125,9 +1128,9 @@ struct Kmer
              *      1) the new mmer is the new minimizer
              *      2) the previous minimizer is invalid or out from the new kmer window.
              */
-            if (_cmp (mmer.value(), kmer._minimizer.value()) == true) // .value()
+            if (_cmp (mmer, kmer._minimizer.value()) == true)
             {
-                kmer._minimizer = mmer; // extract() above has already done the job of querying mmer_lut for revcomp / forbidden kmers
+                kmer._minimizer.set (mmer);
                 kmer._position  = _nbMinimizers - 1;
                 kmer._changed   = true;
             }
@@ -1185,6 +1188,8 @@ struct Kmer
         void setMinimizersFrequency (uint32_t *freq_order)
         {
             _cmp.include_frequency(freq_order);
+            _freq_order = freq_order;
+            if (useWindow ((Comparator*)0))  { _window.setFrequencies (windowFrequencies ((Comparator*)0)); }
 			
 			//Type tmp =_cmp.template computeLargest<ModelType>(getMmersModel(),_minimizerSize);
 			//_minimizerDefault.set (tmp);
@@ -1207,49 +1212,22 @@ struct Kmer
         size_t     _nbMinimizers;
         Type       _mask;
 
-		Type * _mmer_lut;
-        size_t     _shift;
         typename ModelType::Kmer _minimizerDefault;
         bool       _defaultFast;
 
         uint32_t *_freq_order;
-		
 
-        /** Tells whether a minimizer is valid or not, in order to skip minimizers
-         *  that are too frequent. */
-        bool is_allowed (uint32_t mmer, uint32_t len)
-		{
-			if (_freq_order) return true; // every minimizer is allowed in freq order
-			
-			u_int64_t  _mmask_m1  ;
-			u_int64_t  _mask_0101 ;
-			u_int64_t  _mask_ma1 ;
-			
-			//code to ban mmer with AA inside except if at the beginnning
-			// A C T G        00   01   10   11
-			_mmask_m1  = (1 << ((len-2)*2)) -1 ; //vire 2 premieres lettres m = 8  donne    00 00 11 11 11 11 11 11
-			_mask_0101 = 0x5555555555555555  ; //         01 01 01 01 01 01 01 01
-			_mask_ma1  = _mask_0101 & _mmask_m1;//        00 00 01 01 01 01 01 01
-			
-			u_int64_t a1 = mmer; //
-			a1 =   ~(( a1 )   | (  a1 >>2 ));  //
-			a1 =((a1 >>1) & a1) & _mask_ma1 ;  //
-			
-			if(a1 != 0) return false;
-			
-			// if ((mmer & 0x3f) == 0x2a)   return false;   // TTT suffix
-			// if ((mmer & 0x3f) == 0x2e)   return false;   // TGT suffix
-			// if ((mmer & 0x3c) == 0x28)   return false;   // TT* suffix
-			// for (uint32_t j = 0; j < len - 3; ++j)       // AA inside
-			//      if ((mmer & 0xf) == 0)  return false;
-			//      else                    mmer >>= 2;
-			// if (mmer == 0)               return false;   // AAA prefix
-			// if (mmer == 0x04)            return false;   // ACA prefix
-			// if ((mmer & 0xf) == 0)   return false;       // *AA prefix
-			
-			return true;
-		}
-		
+        MinimizerWindow _window;
+
+        /** Tells whether the comparator is an order known by the minimizer window (lexicographic or
+         * frequency), and gives the frequencies to be used by the window for it. */
+        static bool useWindow (const ComparatorMinimizer*)                   { return true;  }
+        static bool useWindow (const ComparatorMinimizerFrequencyOrLex*)     { return true;  }
+        static bool useWindow (const void*)                                  { return false; }
+
+        const uint32_t* windowFrequencies (const ComparatorMinimizerFrequencyOrLex*) const  { return _freq_order; }
+        const uint32_t* windowFrequencies (const void*) const                               { return 0;           }
+
         /** Returns the minimizer of the provided vector of mmers. */
         void computeNewMinimizerOriginal(Kmer& kmer) const
         {
@@ -1259,30 +1237,45 @@ struct Kmer
             kmer._position  = -1;
             kmer._changed   = true;
 
-            typename ModelType::Kmer mmer;
+            /** We get the kmer as 64 bits words and extract all its mmers at once. */
+            u_int64_t words[(span+31)/32];
+            u_int64_t mmers[span];
 
-            /** We compute each mmer and memorize the minimizer among them. */
+            Type   val     = kmer.value(0);
+            size_t nbWords = (2*_kmerModel.getKmerSize() + 63) / 64;
+            for (size_t i=0; i<nbWords; i++)  {  words[i] = val.getVal();  if (i+1 < nbWords)  { val = val >> 64; }  }
 
-            Type kmer_minimizer_value = kmer._minimizer.value();
-            Type val = kmer.value(0);
+            _window.extract (words, _nbMinimizers, mmers);
 
-            for (int16_t idx=_nbMinimizers-1; idx>=0; idx--)
+            /** The first mmer is the most right one in the kmer, ie. the one at the last position. */
+            if (useWindow ((Comparator*)0))
             {
+                u_int64_t minimizer;
+                int t = _window.compute (mmers, _nbMinimizers, minimizer);
 
-                /** We extract the most left mmer in the kmer. */
-                Type candidate_minim = _mmer_lut[(val & _mask).getVal()];
-				
+                if (t >= 0)
+                {
+                    Type mini;  mini.setVal (minimizer);
+                    kmer._minimizer.set (mini);
+                    kmer._position = _nbMinimizers - 1 - t;
+                }
+                return;
+            }
+
+            /** Other comparators: we check each mmer in turn. */
+            Type kmer_minimizer_value = kmer._minimizer.value();
+
+            for (size_t t=0; t<_nbMinimizers; t++)
+            {
+                Type candidate_minim;  candidate_minim.setVal (_window.normalize (mmers[t]));
 
                 /** We check whether this mmer is the new minimizer. */
-                if (_cmp (candidate_minim, kmer_minimizer_value ) == true)  
+                if (_cmp (candidate_minim, kmer_minimizer_value ) == true)
                 {
-                    mmer.set(candidate_minim);
-                    kmer._minimizer = mmer;   
-                    kmer._position = idx; 
-                    kmer_minimizer_value = candidate_minim; 
+                    kmer._minimizer.set (candidate_minim);
+                    kmer._position = _nbMinimizers - 1 - t;
+                    kmer_minimizer_value = candidate_minim;
                 }
-            
-                val >>= 2;    
             }
         }
    
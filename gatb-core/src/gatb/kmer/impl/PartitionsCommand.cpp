@@ -18,8 +18,10 @@
 *****************************************************************************/
 
 #include <gatb/kmer/impl/PartitionsCommand.hpp>
+#include <gatb/kmer/impl/RadixSort.hpp>
 #include <gatb/tools/collections/impl/OAHash.hpp>
 #include <gatb/tools/collections/impl/Hash16.hpp>
+#include <gatb/tools/collections/impl/FlatHash.hpp>
 #include <gatb/tools/misc/impl/Stringify.hpp>
 
 
@@ -371,7 +373,7 @@ PartitionsByHashCommand<span>:: PartitionsByHashCommand (
 template<size_t span>
 void PartitionsByHashCommand<span>:: execute ()
 {
-	typedef typename tools::collections::impl::Hash16<Type>::cell cell_t;
+	typedef typename tools::collections::impl::FlatHash<Type>::cell cell_t;
 
 		this->_superKstorage->openFile("r",this->_parti_num);
 	
@@ -382,7 +384,11 @@ void PartitionsByHashCommand<span>:: execute ()
 	/** We need a map for storing part of solid kmers. */
 	//OAHash<Type> hash (_hashMemory);
 	
-	Hash16<Type> hash16 (_hashMemory/MBYTE); // now use hash 16 to ensure always finish. needs more ram than OAHash but seems faster
+	//Hash16<Type> hash16 (_hashMemory/MBYTE); // now use hash 16 to ensure always finish. needs more ram than OAHash but seems faster
+
+	/** Flat open addressing table (no pointer chasing); it grows on demand and is dumped to disk
+	 * like Hash16 was when it goes over the memory budget, so we always finish. */
+	FlatHash<Type> hash16 (_hashMemory/MBYTE);
 	
 
 	
@@ -502,7 +508,7 @@ void PartitionsByHashCommand<span>:: execute ()
 			
 			//check if hashtable is getting too big : in that case dump it disk and resume with the emptied hashtable
 			//at the end merge-sort all the dumped files with the content of hash table
-			if(hash16.getByteSize() > _hashMemory) // to be improved (can be slightly larger than maxmemory by a block size)
+			if(hash16.isFull() || hash16.getByteSize() > _hashMemory) // to be improved (can be slightly larger than maxmemory by a block size)
 				//if(_tmpCountFileNames.size()<20) //force  dumps for testing
 			{
 				//printf("splitting into subparts %lli KB / %lli KB  parti %i subpart %i \n",hash16.getByteSize()/1024,_hashMemory/1024 ,this->_parti_num,_tmpCountFiles.size()  );
@@ -1172,10 +1178,11 @@ PartitionsByVectorCommand<span>:: PartitionsByVectorCommand (
     size_t              kmerSize,
     MemAllocator&       pool,
     vector<size_t>&     offsets,
-	tools::storage::impl::SuperKmerBinFiles* 		superKstorage
+	tools::storage::impl::SuperKmerBinFiles* 		superKstorage,
+	PartitionSortKind   sortKind
 )
     : PartitionsCommand<span> (/*partition,*/ processor, cacheSize,  progress, timeInfo, pInfo, passi, parti,nbCores,kmerSize,pool,superKstorage),
-        _radix_kmers (0), _bankIdMatrix(0), _radix_sizes(0), _r_idx(0), _nbItemsPerBankPerPart(offsets)
+        _radix_kmers (0), _bankIdMatrix(0), _radix_sizes(0), _r_idx(0), _sortKind(sortKind), _nbItemsPerBankPerPart(offsets)
 {
     _dispatcher = new Dispatcher (this->_nbCores);
 }
@@ -1393,8 +1400,10 @@ public:
     typedef typename Kmer<span>::Type  Type;
 
     /** Constructor. */
-    SortCommand (Type** kmervec, bank::BankIdType** bankIdMatrix, int begin, int end, uint64_t* radix_sizes)
-        : _deb(begin), _fin(end), _radix_kmers(kmervec), _bankIdMatrix(bankIdMatrix), _radix_sizes(radix_sizes) {}
+    SortCommand (Type** kmervec, bank::BankIdType** bankIdMatrix, int begin, int end, uint64_t* radix_sizes,
+        size_t kmerSize, PartitionSortKind sortKind)
+        : _deb(begin), _fin(end), _radix_kmers(kmervec), _bankIdMatrix(bankIdMatrix), _radix_sizes(radix_sizes),
+          _kmerSize(kmerSize), _sortKind(sortKind) {}
 
     /** */
     void execute ()
@@ -1409,7 +1418,16 @@ public:
                 /** Shortcuts. */
                 Type* kmers = _radix_kmers  [ii];
 
-                if (_bankIdMatrix)
+                if (_sortKind == PARTITION_SORT_RADIX)
+                {
+                    /** The kxmers are stored on at most 2*(kmerSize+4) bits. Since they share the same first nucleotides
+                     * (the radix), the sort skips the upper byte in a single counting pass. The bank ids are
+                     * permuted in place with the kmers, so we don't need the 'idx' and 'tmp' vectors. */
+                    RadixSort<Type,bank::BankIdType>::sort (
+                        kmers, _bankIdMatrix ? _bankIdMatrix[ii] : 0, _radix_sizes[ii], 2*(_kmerSize+4)
+                    );
+                }
+                else if (_bankIdMatrix)
                 {
                     /** NOT OPTIMAL AT ALL... in particular we have to use 'idx' and 'tmp' vectors
                      * which may use (a lot of ?) memory. */
@@ -1460,6 +1478,8 @@ private :
     Type**     _radix_kmers;
     bank::BankIdType** _bankIdMatrix;
     uint64_t*  _radix_sizes;
+    size_t     _kmerSize;
+    PartitionSortKind _sortKind;
 };
 
 /*********************************************************************
@@ -1495,7 +1515,8 @@ void PartitionsByVectorCommand<span>::executeSort ()
                 _radix_kmers+ IX(xx,0),
                 (_bankIdMatrix ? _bankIdMatrix+ IX(xx,0) : 0),
                 deb, fin,
-                _radix_sizes + IX(xx,0)
+                _radix_sizes + IX(xx,0),
+                this->_kmerSize, _sortKind
             ));
         }
 
@@ -1821,10 +1842,11 @@ PartitionsByVectorCommand_multibank<span>:: PartitionsByVectorCommand_multibank
 																				 size_t              nbCores,
 																				 size_t              kmerSize,
 																				 MemAllocator&       pool,
-																				 vector<size_t>&     offsets
+																				 vector<size_t>&     offsets,
+																				 PartitionSortKind   sortKind
 																				 )
 : PartitionsCommand_multibank<span> (partition, processor, cacheSize,  progress, timeInfo, pInfo, passi, parti,nbCores,kmerSize,pool),
-_radix_kmers (0), _bankIdMatrix(0), _radix_sizes(0), _r_idx(0), _nbItemsPerBankPerPart(offsets)
+_radix_kmers (0), _bankIdMatrix(0), _radix_sizes(0), _r_idx(0), _sortKind(sortKind), _nbItemsPerBankPerPart(offsets)
 {
 	_dispatcher = new Dispatcher (this->_nbCores);
 }
@@ -2021,7 +2043,8 @@ void PartitionsByVectorCommand_multibank<span>::executeSort ()
 			_radix_kmers+ IX(xx,0),
 			(_bankIdMatrix ? _bankIdMatrix+ IX(xx,0) : 0),
 			deb, fin,
-			_radix_sizes + IX(xx,0)
+			_radix_sizes + IX(xx,0),
+			this->_kmerSize, _sortKind
 												   ));
 		}
 		
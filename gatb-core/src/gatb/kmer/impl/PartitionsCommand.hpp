@@ -239,8 +239,8 @@ public:
 							   size_t                                          kmerSize,
 							   gatb::core::tools::misc::impl::MemAllocator&    pool,
 							   std::vector<size_t>&                            offsets,
-							   tools::storage::impl::SuperKmerBinFiles* 		superKstorage
-							   
+							   tools::storage::impl::SuperKmerBinFiles* 		superKstorage,
+							   tools::misc::PartitionSortKind                  sortKind = tools::misc::PARTITION_SORT_RADIX
 							   );
 	
 	/** Destructor. */
@@ -261,6 +261,8 @@ private:
 	
 	tools::dp::IDispatcher* _dispatcher;
 	
+	tools::misc::PartitionSortKind _sortKind;
+	
 	void executeRead   ();
 	void executeSort   ();
 	void executeDump   ();
@@ -360,7 +362,8 @@ public:
 										 size_t                                          nbCores,
 										 size_t                                          kmerSize,
 										 gatb::core::tools::misc::impl::MemAllocator&    pool,
-										 std::vector<size_t>&                            offsets
+										 std::vector<size_t>&                            offsets,
+										 tools::misc::PartitionSortKind                  sortKind = tools::misc::PARTITION_SORT_RADIX
 										 );
 	
 	/** Destructor. */
@@ -381,6 +384,8 @@ private:
 	
 	tools::dp::IDispatcher* _dispatcher;
 	
+	tools::misc::PartitionSortKind _sortKind;
+	
 	void executeRead   ();
 	void executeSort   ();
 	void executeDump   ();
@@ -0,0 +1,159 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file RadixSort.hpp
+ *  \brief In-place radix sort of kmers
+ */
+
+#ifndef _GATB_CORE_KMER_IMPL_RADIX_SORT_HPP_
+#define _GATB_CORE_KMER_IMPL_RADIX_SORT_HPP_
+
+/********************************************************************************/
+
+#include <algorithm>
+#include <sys/types.h>
+
+/********************************************************************************/
+namespace gatb      {
+namespace core      {
+namespace kmer      {
+namespace impl      {
+/********************************************************************************/
+
+/** \brief In-place MSD radix sort of kmers values.
+ *
+ * The kmers are sorted byte per byte, from the most significant byte to the least
+ * significant one (American flag sort): a counting pass gives the bucket of each byte
+ * value, then the items are moved in place to their bucket by following permutation
+ * cycles, and each bucket is sorted recursively on the next byte. Small buckets are
+ * sorted by insertion.
+ *
+ * The Type template must provide a 'getByte(idx)' method (see LargeInt), so the sort
+ * works for all the kmer spans without shifting multi-words integers.
+ *
+ * An array of identifiers (the bank ids of the kmers for instance) may be provided; it
+ * is permuted the same way as the kmers. The sort is not stable.
+ */
+template<typename Type, typename Id>
+class RadixSort
+{
+public:
+
+    /** Sort an array of kmers.
+     * \param[in] kmers : the kmers to be sorted
+     * \param[in] ids : identifiers permuted with the kmers (may be null)
+     * \param[in] nbItems : number of kmers
+     * \param[in] nbBits : number of significant bits of the kmers (bounded by the size of Type); the upper bits must be the same for all kmers. */
+    static void sort (Type* kmers, Id* ids, size_t nbItems, size_t nbBits)
+    {
+        if (nbItems < 2 || nbBits == 0)  { return; }
+
+        /** The kxmers may be larger than the kmer type; the extra bits are lost anyway. */
+        nbBits = std::min (nbBits, (size_t)Type::getSize());
+
+        if (ids == 0)  {  sortByte<false> (kmers, ids, nbItems, (nbBits-1)/8);  }
+        else           {  sortByte<true>  (kmers, ids, nbItems, (nbBits-1)/8);  }
+    }
+
+private:
+
+    /** Under this number of items, we use insertion sort. */
+    static const size_t INSERTION_SORT_MAX = 32;
+
+    template<bool withIds>
+    static void sortByte (Type* kmers, Id* ids, size_t nbItems, int byteIdx)
+    {
+        for (;;)
+        {
+            if (nbItems <= INSERTION_SORT_MAX)  {  insertionSort<withIds> (kmers, ids, nbItems);  return;  }
+
+            /** We count the items for each value of the current byte. */
+            size_t count[256] = {0};
+            for (size_t i=0; i<nbItems; i++)  {  count[kmers[i].getByte(byteIdx)] ++;  }
+
+            /** All the items are in the same bucket => we go directly to the next byte. */
+            if (count[kmers[0].getByte(byteIdx)] == nbItems)
+            {
+                if (byteIdx == 0)  { return; }
+                byteIdx--;
+                continue;
+            }
+
+            size_t head[256];
+            size_t tail[256];
+            for (size_t d=0, offset=0; d<256; d++)  {  head[d] = offset;  offset += count[d];  tail[d] = offset;  }
+
+            /** We move each item to its bucket, following the permutation cycles. */
+            for (size_t d=0; d<256; d++)
+            {
+                while (head[d] < tail[d])
+                {
+                    Type kmer = kmers[head[d]];
+                    Id   id   = withIds ? ids[head[d]] : Id();
+
+                    for (size_t b = kmer.getByte(byteIdx);  b != d;  b = kmer.getByte(byteIdx))
+                    {
+                        size_t dest = head[b]++;
+                        std::swap (kmer, kmers[dest]);
+                        if (withIds)  {  std::swap (id, ids[dest]);  }
+                    }
+
+                    kmers[head[d]] = kmer;
+                    if (withIds)  {  ids[head[d]] = id;  }
+                    head[d]++;
+                }
+            }
+
+            if (byteIdx == 0)  { return; }
+
+            /** We sort each bucket on the next byte. */
+            for (size_t d=0, offset=0; d<256; offset += count[d], d++)
+            {
+                if (count[d] > 1)  {  sortByte<withIds> (kmers + offset, withIds ? ids + offset : ids, count[d], byteIdx-1);  }
+            }
+            return;
+        }
+    }
+
+    template<bool withIds>
+    static void insertionSort (Type* kmers, Id* ids, size_t nbItems)
+    {
+        for (size_t i=1; i<nbItems; i++)
+        {
+            Type kmer = kmers[i];
+            Id   id   = withIds ? ids[i] : Id();
+
+            size_t j = i;
+            for ( ; j>0 && kmer < kmers[j-1]; j--)
+            {
+                kmers[j] = kmers[j-1];
+                if (withIds)  {  ids[j] = ids[j-1];  }
+            }
+
+            kmers[j] = kmer;
+            if (withIds)  {  ids[j] = id;  }
+        }
+    }
+};
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_KMER_IMPL_RADIX_SORT_HPP_ */
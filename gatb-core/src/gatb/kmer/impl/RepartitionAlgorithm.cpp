@@ -99,20 +99,26 @@ public:
     typedef typename ModelCanonical::Kmer                       KmerTypeCanonical;
     typedef typename RepartitorAlgorithm<span>::ModelDirect    ModelDirect;
     typedef typename ModelDirect::Kmer                       KmerTypeDirect;
+    typedef typename Kmer<span>::Type                        Type;
 
     void operator() (Sequence& sequence)
     {
-        /** We first check whether we got mmers from the sequence or not. */
-        if (_minimodel.build (sequence.getData(), _mmers) == false)  { return; }
+        Data& data = sequence.getData();
+
+        /** We get the canonical mmers of the sequence in one go; we first check whether we got mmers or not. */
+        if (_mmers.size() < data.size())  {  _mmers.resize (data.size());  _invalid.resize (data.size()/64 + 1);  }
+
+        size_t nbMmers = _minimodel.buildBatch (data, 0, 0, _mmers.data(), _invalid.data());
+        if (nbMmers == 0)  { return; }
 
         /** We loop over the mmers of the sequence. */
-        for (size_t i=0; i<_mmers.size(); i++)
+        for (size_t i=0; i<nbMmers; i++)
         {
-            if (_mmers[i].isValid() == false)
+            if ((_invalid[i>>6] >> (i&63)) & 1)
                 continue;
 
             /** increment m-mer count */
-            _m_mer_counts[_mmers[i].value().getVal()] ++;
+            _m_mer_counts[_mmers[i].getVal()] ++;
         }
 
         if (_nbProcessedMmers > 500000)   {  _progress.inc (_nbProcessedMmers);  _nbProcessedMmers = 0;  }
@@ -142,8 +148,8 @@ protected:
 
     ModelCanonical           _minimodel;
     //ModelDirect                _minimodel;
-    vector<KmerTypeCanonical>  _mmers;
-    //vector<KmerTypeDirect>  _mmers;
+    vector<Type>               _mmers;
+    vector<u_int64_t>          _invalid;
     ProgressSynchro         _progress;
     uint32_t*               _m_mer_counts;
     size_t                  _nbProcessedMmers;
@@ -30,8 +30,11 @@
 #include <gatb/kmer/impl/RepartitionAlgorithm.hpp>
 #include <gatb/tools/misc/impl/Progress.hpp>
 #include <gatb/bank/impl/Bank.hpp>
+#include <gatb/bank/impl/BankFasta.hpp>
+#include <gatb/bank/impl/BankBinary.hpp>
 #include <gatb/tools/collections/impl/IterableHelpers.hpp>
 #include <cmath>
+#include <functional>
 
 #define DEBUG(a)  //printf a
 
@@ -229,6 +232,13 @@ IOptionsParser* SortingCountAlgorithm<span>::getOptionsParser (bool mandatory)
     devParser->push_back (new OptionOneParam (STR_MINIMIZER_TYPE,    "minimizer type (0=lexi, 1=freq)",                false, "0"));
     devParser->push_back (new OptionOneParam (STR_MINIMIZER_SIZE,    "size of a minimizer",                            false, "10"));
     devParser->push_back (new OptionOneParam (STR_REPARTITION_TYPE,  "minimizer repartition (0=unordered, 1=ordered)", false, "0"));
+    devParser->push_back (new OptionOneParam (STR_PARSER_THREADS,    "number of threads parsing FASTA/FASTQ files (0=parsing in the iterating thread)", false, "0"));
+    devParser->push_back (new OptionNoParam  (STR_BINARY_MMAP,       "read binary banks through a memory mapping",     false));
+    devParser->push_back (new OptionOneParam (STR_PARTITION_SORT,    "sort of the kmers of a partition ('radix' or 'std')", false, "radix"));
+    devParser->push_back (new OptionNoParam  (STR_PIPELINE_PASSES,   "count the partitions of a pass while filling the next pass (several passes only)", false));
+    devParser->push_back (new OptionNoParam  (STR_DISK_PARTITIONS,   "always write the partitions into temporary files, even when they fit in memory", false));
+    devParser->push_back (new OptionNoParam  (STR_COMPRESS_PARTITIONS, "compress the partitions (less disk space and passes, for 'sum' solidity)", false));
+    devParser->push_back (new OptionNoParam  (STR_ASYNC_WRITES,      "write the partitions from a dedicated thread (for 'sum' solidity)", false));
     parser->push_back (devParser);
 
     return parser;
@@ -492,6 +502,12 @@ void SortingCountAlgorithm<span>::configure ()
         _bank, _config._isComputed, _repartitor
     ));
 
+    /** We may have to parse FASTA/FASTQ files with several threads. */
+    if (getInput()->get(STR_PARSER_THREADS))  {  BankFasta::setNbParserThreads (getInput()->getInt(STR_PARSER_THREADS));  }
+
+    /** We may have to read binary banks through a memory mapping. */
+    if (getInput()->get(STR_BINARY_MMAP))  {  BankBinary::setMemoryMapped (true);  }
+
     /** We check that the bank is ok, otherwise we build one. */
     if (_bank == 0)    {  setBank (Bank::open (getInput()->getStr(STR_URI_INPUT)));  }
 
@@ -639,7 +655,8 @@ void SortingCountAlgorithm<span>::execute ()
     /*                         MAIN LOOP                         */
     /*************************************************************/
     /** We loop N times the bank. For each pass, we will consider a subset of the whole kmers set of the bank. */
-    for (size_t current_pass=0; current_pass < _config._nb_passes; current_pass++)
+    if (_config._pipelinePasses)  {  executePipelined (itSeq, pInfo);  }
+    else for (size_t current_pass=0; current_pass < _config._nb_passes; current_pass++)
     {
         DEBUG (("SortingCountAlgorithm<span>::execute  pass [%ld,%d] \n", current_pass+1, _config._nb_passes));
 
@@ -649,7 +666,7 @@ void SortingCountAlgorithm<span>::execute ()
         fillPartitions (current_pass, itSeq, pInfo);
 
         /** 2) We fill the kmers solid file from the partition files. */
-        fillSolidKmers (current_pass, pInfo);
+        fillSolidKmers (current_pass, pInfo, _superKstorage);
     }
 
     /** We notify the count processor about the stop of the main loop. */
@@ -744,6 +761,73 @@ void SortingCountAlgorithm<span>::execute ()
     getInfo()->add (1, getTimeInfo().getProperties("time"));
 }
 
+/********************************************************************************/
+/* Command running a functor; used for running the filling of a pass and the counting of
+ * the previous one in two threads. */
+template<typename Functor>
+class PipelineCommand : public ICommand, public system::SmartPointer
+{
+public:
+    PipelineCommand (Functor fct) : _fct(fct)  {}
+    void execute ()  {  _fct();  }
+private:
+    Functor _fct;
+};
+
+template<typename Functor>
+ICommand* makePipelineCommand (Functor fct)  {  return new PipelineCommand<Functor> (fct);  }
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE : loop over the passes; the partitions of the pass N+1 are filled (disk bound)
+**           while the partitions of the pass N are counted (cpu bound).
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the superkmers files of two passes are alive at the same time; the configuration
+**           took it into account for the disk space and the count memory.
+*********************************************************************/
+template<size_t span>
+void SortingCountAlgorithm<span>::executePipelined (Iterator<Sequence>* itSeq, PartiInfo<5>& pInfo)
+{
+    /** We need another PartiInfo for the pass being filled while counting. */
+    PartiInfo<5> pInfoOther (_config._nb_partitions, _config._minim_size);
+
+    PartiInfo<5>* pInfoCount = &pInfo;
+    PartiInfo<5>* pInfoFill  = &pInfoOther;
+
+    /** We fill the partition files of the first pass. */
+    pInfoCount->clear();
+    fillPartitions (0, itSeq, *pInfoCount);
+
+    for (size_t current_pass=0; current_pass < _config._nb_passes; current_pass++)
+    {
+        DEBUG (("SortingCountAlgorithm<span>::executePipelined  pass [%ld,%d] \n", current_pass+1, _config._nb_passes));
+
+        /** We take the partitions to be counted, so fillPartitions doesn't delete them. */
+        SuperKmerBinFiles* superKstorage = _superKstorage;
+        _superKstorage = 0;
+
+        vector<ICommand*> cmds;
+
+        cmds.push_back (makePipelineCommand ([&] ()  {  fillSolidKmers (current_pass, *pInfoCount, superKstorage);  }));
+
+        if (current_pass+1 < _config._nb_passes)
+        {
+            pInfoFill->clear();
+            cmds.push_back (makePipelineCommand ([&] ()  {  fillPartitions (current_pass+1, itSeq, *pInfoFill);  }));
+        }
+
+        getDispatcher()->dispatchCommands (cmds, 0);
+
+        /** We keep the last partitions for the statistics, they are deleted at the end of execute. */
+        if (_superKstorage != 0)  {  delete superKstorage;  }
+        else                      {  _superKstorage = superKstorage;  }
+
+        std::swap (pInfoCount, pInfoFill);
+    }
+}
+
 /********************************************************************************/
 /* This functor class takes a Sequence as input, splits it into super kmers and
  * serialize them into partitions.
@@ -1200,7 +1284,9 @@ void SortingCountAlgorithm<span>::fillPartitions (size_t pass, Iterator<Sequence
 		else
 		{
 			/** We build the temporary storage name from the output storage name. */
-			_tmpStorageName_superK = getInput()->getStr(STR_URI_OUTPUT_TMP) + "/" + System::file().getTemporaryFilename("superK_partitions");
+			_tmpStorageName_superK = getInput()->getStr(STR_URI_OUTPUT_TMP) + "/" + System::file().getTemporaryFilename(
+				Stringify::format ("superK_partitions_%d", pass)  // two passes may be on disk in pipelined mode
+			);
 			
 			
 			if(_superKstorage!=0)
@@ -1209,7 +1295,7 @@ void SortingCountAlgorithm<span>::fillPartitions (size_t pass, Iterator<Sequence
 				_superKstorage =0;
 			}
 			
-			_superKstorage = new SuperKmerBinFiles(_tmpStorageName_superK,"superKparts", _config._nb_partitions) ;
+			_superKstorage = new SuperKmerBinFiles(_tmpStorageName_superK,"superKparts", _config._nb_partitions, _config._inMemoryPartitions, _config._compressPartitions, _config._asyncWrites) ;
 			
 		}
 		/** We update the message of the progress bar. */
@@ -1303,21 +1389,59 @@ void SortingCountAlgorithm<span>::fillPartitions (size_t pass, Iterator<Sequence
 ** REMARKS :
 *********************************************************************/
 template<size_t span>
-std::vector<size_t> SortingCountAlgorithm<span>::getNbCoresList (PartiInfo<5>& pInfo)
+std::vector<std::vector<std::pair<size_t,size_t> > > SortingCountAlgorithm<span>::getPartitionsSchedule (PartiInfo<5>& pInfo)
 {
-    std::vector<size_t> result;
+    std::vector<std::vector<std::pair<size_t,size_t> > > result;
+
+    u_int64_t maxMemory = (u_int64_t)_config.getCountMemory()*MBYTE;
+
+    /** The cost of a partition is its number of kmers; we schedule the biggest partitions first (LPT),
+     * so a big partition at the end of the list can't leave most of the threads idle. */
+    std::vector<std::pair<u_int64_t,size_t> > partitions;
+    for (size_t p=0; p<_config._nb_partitions; p++)  {  partitions.push_back (std::make_pair (pInfo.getNbKmer(p), p));  }
+    std::stable_sort (partitions.begin(), partitions.end(), std::greater<std::pair<u_int64_t,size_t> >());
 
-    for (size_t p=0; p<_config._nb_partitions; )
+    std::vector<bool> done (partitions.size(), false);
+
+    for (size_t first=0; first<partitions.size(); first++)
     {
+        if (done[first])  { continue; }
+
+        /** A group starts with the biggest remaining partition; we complete it with the next partitions
+         * that fit into the memory, so several small partitions may be counted beside a big one. */
+        std::vector<size_t> group;
         u_int64_t ram_total = 0;
-        size_t i=0;
-        for (i=0; i< _config._nb_partitions_in_parallel && p<_config._nb_partitions
-            && (ram_total ==0  || ((ram_total+(pInfo.getNbSuperKmer(p)*getSizeofPerItem()))  <= _config._max_memory*MBYTE)) ; i++, p++)
+        u_int64_t cost_total = 0;
+
+        for (size_t i=first; i<partitions.size() && group.size() < _config._nb_partitions_in_parallel; i++)
+        {
+            if (done[i])  { continue; }
+
+            u_int64_t ram = pInfo.getNbSuperKmer(partitions[i].second)*getSizeofPerItem();
+
+            if (ram_total == 0  ||  ram_total + ram <= maxMemory)
+            {
+                group.push_back (i);
+                done[i]     = true;
+                ram_total  += ram;
+                cost_total += partitions[i].first;
+            }
+        }
+
+        /** The cores are shared among the partitions of the group according to their cost, so a big
+         * partition gets the cores not needed by the small ones (at least one core per partition). */
+        std::vector<std::pair<size_t,size_t> > groupCores;
+        for (size_t i=0; i<group.size(); i++)
         {
-            ram_total += pInfo.getNbSuperKmer(p)*getSizeofPerItem();
+            u_int64_t cost  = partitions[group[i]].first;
+            size_t    cores = cost_total == 0 ?
+                _config._nbCores_per_partition :
+                (size_t) ((double)_config._nbCores * cost / cost_total);
+
+            groupCores.push_back (std::make_pair (partitions[group[i]].second, std::max ((size_t)1, std::min (cores, _config._nbCores))));
         }
 
-        result.push_back (i);
+        result.push_back (groupCores);
     }
 
     return result;
@@ -1332,7 +1456,7 @@ std::vector<size_t> SortingCountAlgorithm<span>::getNbCoresList (PartiInfo<5>& p
 ** REMARKS :
 *********************************************************************/
 template<size_t span>
-void SortingCountAlgorithm<span>::fillSolidKmers (size_t pass, PartiInfo<5>& pInfo)
+void SortingCountAlgorithm<span>::fillSolidKmers (size_t pass, PartiInfo<5>& pInfo, SuperKmerBinFiles* superKstorage)
 {
     TIME_INFO (getTimeInfo(), "fill_solid_kmers");
 
@@ -1341,7 +1465,7 @@ void SortingCountAlgorithm<span>::fillSolidKmers (size_t pass, PartiInfo<5>& pIn
         /** We notify the count processor about the start of the pass. */
         _processors[i]->beginPass (pass);
 
-        fillSolidKmers_aux (_processors[i], pass, pInfo);
+        fillSolidKmers_aux (_processors[i], pass, pInfo, superKstorage);
 
         /** We notify the count processor about the end of the pass. */
         _processors[i]->endPass (pass);
@@ -1357,7 +1481,7 @@ void SortingCountAlgorithm<span>::fillSolidKmers (size_t pass, PartiInfo<5>& pIn
 ** REMARKS :
 *********************************************************************/
 template<size_t span>
-void SortingCountAlgorithm<span>::fillSolidKmers_aux (ICountProcessor<span>* processor, size_t pass, PartiInfo<5>& pInfo)
+void SortingCountAlgorithm<span>::fillSolidKmers_aux (ICountProcessor<span>* processor, size_t pass, PartiInfo<5>& pInfo, SuperKmerBinFiles* superKstorage)
 {
     DEBUG (("SortingCountAlgorithm<span>::fillSolidKmers\n"));
 
@@ -1365,29 +1489,29 @@ void SortingCountAlgorithm<span>::fillSolidKmers_aux (ICountProcessor<span>* pro
     _progress->setMessage (Stringify::format (progressFormat2, pass+1, _config._nb_passes));
 
 
-    /** We retrieve the list of cores number for dispatching N partitions in N threads.
-     *  We need to know these numbers for allocating the N maps according to the maximum allowed memory.
+    /** We retrieve the groups of partitions counted simultaneously, with the cores of each partition.
+     *  We need to know the groups sizes for allocating the N maps according to the maximum allowed memory.
      */
-    vector<size_t> coreList = getNbCoresList(pInfo); //uses _nb_partitions_in_parallel
+    vector<vector<pair<size_t,size_t> > > schedule = getPartitionsSchedule(pInfo); //uses _nb_partitions_in_parallel
 
     /** We need a memory allocator. We give the cores number in order to compute an extra memory
-     * allocation for alignment constraints. */
-    MemAllocator pool (_config._nbCores);
+     * allocation for alignment constraints. Since each partition of a group has at least one core,
+     * a group may use up to twice the cores number. */
+    MemAllocator pool (2*_config._nbCores);
 
-    size_t p = 0;
-    for (size_t i=0; i<coreList.size(); i++)
+    for (size_t i=0; i<schedule.size(); i++)
     {
         vector<ICommand*> cmds;
 
         /** We use a vector to hold all the current CountProcessor clones. */
         vector<CountProcessor*> clones;
 
-        size_t currentNbCores = coreList[i];
+        size_t currentNbCores = schedule[i].size();
         assert (currentNbCores > 0);
 
         /** We correct the number of memory per map according to the max allowed memory.
          * Note that _max_memory has initially been divided by the user provided cores number. */
-        u_int64_t mem = (_config._max_memory*MBYTE)/currentNbCores;
+        u_int64_t mem = ((u_int64_t)_config.getCountMemory()*MBYTE)/currentNbCores;
 
         /** We need to cache the solid kmers partitions.
          *  NOTE : it is important to save solid kmers by big chunks (ie cache size) in each partition.
@@ -1404,8 +1528,11 @@ void SortingCountAlgorithm<span>::fillSolidKmers_aux (ICountProcessor<span>* pro
         ));
 
         /** We build a list of 'currentNbCores' commands to be dispatched each one in one thread. */
-        for (size_t j=0; j<currentNbCores; j++, p++)
+        for (size_t j=0; j<currentNbCores; j++)
         {
+            size_t p              = schedule[i][j].first;
+            size_t nbCoresForPart = schedule[i][j].second;
+
             ISynchronizer* synchro = System::thread().newSynchronizer();
             LOCAL (synchro);
 
@@ -1431,20 +1558,20 @@ void SortingCountAlgorithm<span>::fillSolidKmers_aux (ICountProcessor<span>* pro
 
             //still use hash if by vector would be too large even with single part at a time
 			//I thought it was not possible to have memoryPartition > _max_memory  && currentNbCores>1 , but inf fact it is possible when
-			// some partitions are of size 0 (see getNbCoresList)
-			if ( ((memoryPartition > mem && currentNbCores==1) || ( memoryPartition > (_config._max_memory*MBYTE) ) )  && !forceVector)
+			// some partitions are of size 0 (see getPartitionsSchedule)
+			if ( ((memoryPartition > mem && currentNbCores==1) || ( memoryPartition > ((u_int64_t)_config.getCountMemory()*MBYTE) ) )  && !forceVector)
             {
                 if (pool.getCapacity() != 0)  {  pool.reserve(0);  }
 
 
 					cmd = new PartitionsByHashCommand<span>   (
 															   processorClone, cacheSize, _progress, _fillTimeInfo,
-															   pInfo, pass, p, _config._nbCores_per_partition, _config._kmerSize, pool, mem,_superKstorage
+															   pInfo, pass, p, nbCoresForPart, _config._kmerSize, pool, mem,superKstorage
 															   );
             }
             else
             {
-                u_int64_t memoryPoolSize = _config._max_memory*MBYTE;
+                u_int64_t memoryPoolSize = (u_int64_t)_config.getCountMemory()*MBYTE;
 
                 /** In case of forcing sorted vector (multiple banks counting for instance), we may have a
                  * partition bigger than the max memory. */
@@ -1515,14 +1642,16 @@ void SortingCountAlgorithm<span>::fillSolidKmers_aux (ICountProcessor<span>* pro
 				{
 					cmd = new PartitionsByVectorCommand<span> (
 															   processorClone, cacheSize, _progress, _fillTimeInfo,
-															   pInfo, pass, p, _config._nbCores_per_partition, _config._kmerSize, pool, nbItemsPerBankPerPart,_superKstorage
+															   pInfo, pass, p, nbCoresForPart, _config._kmerSize, pool, nbItemsPerBankPerPart,superKstorage,
+															   _config._partitionSort
 															   );
 				}
 				else
 				{
 					cmd = new PartitionsByVectorCommand_multibank<span> (
 															   (*_tmpPartitions)[p], processorClone, cacheSize, _progress, _fillTimeInfo,
-															   pInfo, pass, p, _config._nbCores_per_partition, _config._kmerSize, pool, nbItemsPerBankPerPart
+															   pInfo, pass, p, nbCoresForPart, _config._kmerSize, pool, nbItemsPerBankPerPart,
+															   _config._partitionSort
 															   );
 				}
 
@@ -1548,7 +1677,7 @@ void SortingCountAlgorithm<span>::fillSolidKmers_aux (ICountProcessor<span>* pro
 	
 	
 	if(_config._solidityKind == KMER_SOLIDITY_SUM)
-		_superKstorage->closeFiles();
+		superKstorage->closeFiles();
 
 }
 
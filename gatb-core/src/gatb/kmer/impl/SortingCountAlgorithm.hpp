@@ -205,15 +205,24 @@ private:
     /** Fill the solid kmers bag from the partition files (one partition after another one).
      * \param[in] solidKmers : bag to put the solid kmers into.
      */
-    void fillSolidKmers (size_t pass, PartiInfo<5>& pInfo);
+    void fillSolidKmers (size_t pass, PartiInfo<5>& pInfo, tools::storage::impl::SuperKmerBinFiles* superKstorage);
 
     /** Fill the solid kmers bag from the partition files (one partition after another one).
      * \param[in] solidKmers : bag to put the solid kmers into.
      */
-    void fillSolidKmers_aux (ICountProcessor<span>* processor, size_t pass, PartiInfo<5>& pInfo);
+    void fillSolidKmers_aux (ICountProcessor<span>* processor, size_t pass, PartiInfo<5>& pInfo, tools::storage::impl::SuperKmerBinFiles* superKstorage);
 
-    /** */
-    std::vector <size_t> getNbCoresList (PartiInfo<5>& pInfo);
+    /** Loop over the passes, filling the partitions of a pass while counting the partitions of the previous one.
+     * \param[in] itSeq : sequences iterator whose sequence are cut into kmers to be split.
+     * \param[in] pInfo : partitions information of the first pass
+     */
+    void executePipelined (gatb::core::tools::dp::Iterator<gatb::core::bank::Sequence>* itSeq, PartiInfo<5>& pInfo);
+
+    /** Schedule the counting of the partitions of a pass. The partitions are split into groups counted
+     * simultaneously, each partition of a group coming with its number of cores.
+     * \param[in] pInfo : partitions information of the pass
+     * \return the groups of [partition id, cores number] */
+    std::vector <std::vector <std::pair<size_t,size_t> > > getPartitionsSchedule (PartiInfo<5>& pInfo);
 
     /** Handle on the configuration information. */
     kmer::impl::Configuration _config;
@@ -18,6 +18,7 @@
 *****************************************************************************/
 
 #include <gatb/system/impl/System.hpp>
+#include <gatb/system/impl/WorkerPool.hpp>
 
 /********************************************************************************/
 namespace gatb { namespace core { namespace system { namespace impl {
@@ -77,7 +78,10 @@ ThreadGroup::~ThreadGroup()
 *********************************************************************/
 void ThreadGroup::add (void* (*mainloop) (void*), void* data)
 {
-    IThread* thr = System::thread().newThread (mainloop, data);
+    /** We use a persistent worker if possible, rather than creating a thread for each group. */
+    IThread* thr = WorkerPool::isEnabled() ?
+        WorkerPool::singleton().newThread (mainloop, data) :
+        System::thread().newThread (mainloop, data);
 
     _threads.push_back (thr);
 }
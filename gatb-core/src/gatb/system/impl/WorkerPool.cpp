@@ -0,0 +1,434 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include <gatb/system/impl/WorkerPool.hpp>
+#include <gatb/system/api/Exception.hpp>
+
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+using namespace std;
+
+#define DEBUG(a)  //printf a
+
+/********************************************************************************/
+namespace gatb { namespace core { namespace system { namespace impl {
+/********************************************************************************/
+
+/* A worker waits for a main loop to be run; 'isDone' tells whether the last one is finished. */
+struct worker_t
+{
+    worker_t (size_t idx) : idx(idx), mainloop(0), data(0), hasTask(false), isDone(true)  {}
+
+    size_t    idx;
+    pthread_t thread;
+
+    void* (*mainloop) (void*);
+    void*   data;
+    bool    hasTask;
+    bool    isDone;
+
+    std::mutex              mutex;
+    std::condition_variable cond;
+};
+
+/* State of the pool. */
+struct pool_t
+{
+    pool_t () : affinity(WorkerPool::AFFINITY_NONE)  {}
+
+    std::mutex              mutex;
+    std::vector<worker_t*>  workers;
+    std::vector<worker_t*>  idle;
+
+    WorkerPool::Affinity_e  affinity;
+    std::vector<int>        allowed;  // cores allowed for the process
+    std::vector<int>        cores;    // core of the worker i is cores[i%cores.size()]
+};
+
+static bool POOL_ENABLED = true;
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE : main loop of a worker
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : a worker never stops; it dies with the process
+*********************************************************************/
+static void* worker_mainloop (void* arg)
+{
+    worker_t* worker = (worker_t*) arg;
+
+    for (;;)
+    {
+        void* (*mainloop) (void*) = 0;
+        void* data = 0;
+
+        /** We wait for some main loop to be run. */
+        {
+            std::unique_lock<std::mutex> lock (worker->mutex);
+            worker->cond.wait (lock, [worker] { return worker->hasTask; });
+            mainloop = worker->mainloop;
+            data     = worker->data;
+        }
+
+        mainloop (data);
+
+        /** We tell that the main loop is finished. */
+        {
+            std::lock_guard<std::mutex> lock (worker->mutex);
+            worker->hasTask = false;
+            worker->isDone  = true;
+        }
+        worker->cond.notify_all ();
+    }
+
+    return 0;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE : get the list of cores of a NUMA node
+** INPUT   : node index
+** OUTPUT  : cores of the node
+** RETURN  : false if the node doesn't exist
+** REMARKS : the list looks like "0-3,8-11"
+*********************************************************************/
+static bool getNodeCores (int node, std::vector<int>& cores)
+{
+    char path[256];
+    snprintf (path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+
+    FILE* file = fopen (path, "r");
+    if (file == 0)  { return false; }
+
+    char line[4096];
+    if (fgets (line, sizeof(line), file) != 0)
+    {
+        for (char* token = strtok (line, ",\n"); token != 0; token = strtok (0, ",\n"))
+        {
+            int first=0, last=0;
+            int nb = sscanf (token, "%d-%d", &first, &last);
+            if (nb == 1)  { last = first; }
+            if (nb >= 1)  {  for (int c=first; c<=last; c++)  { cores.push_back (c); }  }
+        }
+    }
+
+    fclose (file);
+    return true;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE : compute the cores the workers are pinned on
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the pool mutex must be locked
+*********************************************************************/
+static void computeCores (pool_t* pool)
+{
+    pool->cores.clear();
+
+#ifdef __linux__
+    /** We get the cores allowed for the process once; the calling thread may be a pinned worker afterwards. */
+    if (pool->allowed.empty())
+    {
+        cpu_set_t set;
+        CPU_ZERO (&set);
+        if (sched_getaffinity (0, sizeof(set), &set) == 0)
+        {
+            for (int c=0; c<CPU_SETSIZE; c++)  {  if (CPU_ISSET (c, &set))  { pool->allowed.push_back (c); }  }
+        }
+    }
+
+    if (pool->affinity == WorkerPool::AFFINITY_CORES)  {  pool->cores = pool->allowed;  }
+
+    if (pool->affinity == WorkerPool::AFFINITY_NUMA)
+    {
+        /** We get the allowed cores of each node. */
+        std::vector<std::vector<int> > nodes;
+        std::vector<int> nodeCores;
+        for (int n=0; getNodeCores (n, nodeCores); n++)
+        {
+            std::vector<int> cores;
+            for (size_t i=0; i<nodeCores.size(); i++)
+            {
+                for (size_t j=0; j<pool->allowed.size(); j++)  {  if (pool->allowed[j] == nodeCores[i])  { cores.push_back (nodeCores[i]); }  }
+            }
+            if (cores.empty() == false)  { nodes.push_back (cores); }
+            nodeCores.clear();
+        }
+
+        /** We interleave the nodes, so consecutive workers are on different nodes. */
+        for (size_t i=0; nodes.empty()==false; i++)
+        {
+            bool found = false;
+            for (size_t n=0; n<nodes.size(); n++)  {  if (i < nodes[n].size())  { pool->cores.push_back (nodes[n][i]);  found = true; }  }
+            if (!found)  { break; }
+        }
+
+        /** No NUMA information available => we use the allowed cores. */
+        if (pool->cores.empty())  {  pool->cores = pool->allowed;  }
+    }
+#endif
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE : pin a worker according to the affinity of the pool
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the pool mutex must be locked
+*********************************************************************/
+static void pin (pool_t* pool, worker_t* worker)
+{
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO (&set);
+
+    if (pool->cores.empty() == false)
+    {
+        CPU_SET (pool->cores [worker->idx % pool->cores.size()], &set);
+    }
+    else if (pool->allowed.empty() == false)
+    {
+        /** No pinning => the worker may run on any allowed core. */
+        for (size_t i=0; i<pool->allowed.size(); i++)  { CPU_SET (pool->allowed[i], &set); }
+    }
+    else  { return; }
+
+    pthread_setaffinity_np (worker->thread, sizeof(set), &set);
+#endif
+}
+
+/********************************************************************************/
+
+/* Thread given by the pool; deleting it gives the worker back to the pool. */
+class PooledThread : public IThread, public system::SmartPointer
+{
+public:
+
+    PooledThread (pool_t* pool, worker_t* worker) : _pool(pool), _worker(worker)  {}
+
+    ~PooledThread ()
+    {
+        join ();
+
+        std::lock_guard<std::mutex> lock (_pool->mutex);
+        _pool->idle.push_back (_worker);
+    }
+
+    void join ()
+    {
+        std::unique_lock<std::mutex> lock (_worker->mutex);
+        _worker->cond.wait (lock, [this] { return _worker->isDone; });
+    }
+
+    Id getId () const { return (Id) _worker->thread; }
+
+private:
+    pool_t*   _pool;
+    worker_t* _worker;
+};
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the pool is never deleted, since its workers may be used until the end of the process
+*********************************************************************/
+WorkerPool& WorkerPool::singleton ()
+{
+    static WorkerPool* instance = new WorkerPool();
+    return *instance;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+WorkerPool::WorkerPool () : _pool (new pool_t())
+{
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+WorkerPool::~WorkerPool ()
+{
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+IThread* WorkerPool::newThread (void* (*mainloop) (void*), void* data)
+{
+    pool_t*   pool   = (pool_t*) _pool;
+    worker_t* worker = 0;
+
+    {
+        std::lock_guard<std::mutex> lock (pool->mutex);
+
+        if (pool->idle.empty() == false)
+        {
+            /** We take the most recently used worker. */
+            worker = pool->idle.back();
+            pool->idle.pop_back();
+        }
+        else
+        {
+            /** No idle worker => we create a new one. */
+            worker = new worker_t (pool->workers.size());
+
+            if (pthread_create (&worker->thread, NULL, worker_mainloop, worker) != 0)
+            {
+                delete worker;
+                throw Exception ("unable to create a thread");
+            }
+
+            pool->workers.push_back (worker);
+
+            if (pool->affinity != AFFINITY_NONE)  { pin (pool, worker); }
+
+            DEBUG (("WorkerPool::newThread  new worker %ld\n", worker->idx));
+        }
+    }
+
+    /** We give the main loop to the worker. */
+    {
+        std::lock_guard<std::mutex> lock (worker->mutex);
+        worker->mainloop = mainloop;
+        worker->data     = data;
+        worker->isDone   = false;
+        worker->hasTask  = true;
+    }
+    worker->cond.notify_all ();
+
+    return new PooledThread (pool, worker);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+size_t WorkerPool::getNbWorkers ()
+{
+    pool_t* pool = (pool_t*) _pool;
+
+    std::lock_guard<std::mutex> lock (pool->mutex);
+    return pool->workers.size();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void WorkerPool::setAffinity (Affinity_e affinity)
+{
+    pool_t* pool = (pool_t*) _pool;
+
+    std::lock_guard<std::mutex> lock (pool->mutex);
+
+    pool->affinity = affinity;
+    computeCores (pool);
+
+    /** We pin the already created workers. */
+    for (size_t i=0; i<pool->workers.size(); i++)  { pin (pool, pool->workers[i]); }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+WorkerPool::Affinity_e WorkerPool::getAffinity ()
+{
+    pool_t* pool = (pool_t*) _pool;
+
+    std::lock_guard<std::mutex> lock (pool->mutex);
+    return pool->affinity;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void WorkerPool::setEnabled (bool enabled)
+{
+    POOL_ENABLED = enabled;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+bool WorkerPool::isEnabled ()
+{
+    return POOL_ENABLED;
+}
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
@@ -0,0 +1,110 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file WorkerPool.hpp
+ *  \brief Process-wide pool of persistent threads
+ */
+
+#ifndef _GATB_CORE_SYSTEM_IMPL_WORKER_POOL_HPP_
+#define _GATB_CORE_SYSTEM_IMPL_WORKER_POOL_HPP_
+
+/********************************************************************************/
+
+#include <gatb/system/api/IThread.hpp>
+
+/********************************************************************************/
+namespace gatb      {
+namespace core      {
+namespace system    {
+namespace impl      {
+/********************************************************************************/
+
+/** \brief Pool of persistent threads shared by the whole process.
+ *
+ * Tools dispatch a lot of short parallel jobs (one per partition, one per simplification
+ * pass...); creating and joining threads for each of them has a cost. Instead, the
+ * threads of this pool are created on demand and then reused: newThread runs the
+ * provided main loop on an idle worker (a new worker is created only if none is idle)
+ * and returns an IThread whose join waits for the end of the main loop. The worker goes
+ * back to the pool when this IThread is deleted, so a worker can't belong to two thread
+ * groups at the same time (see ThreadGroup::find).
+ *
+ * The workers can be pinned on the cores allowed for the process; with the NUMA
+ * affinity, consecutive workers are spread over the NUMA nodes.
+ *
+ * ThreadGroup uses this pool (and so does Dispatcher), unless it is disabled with setEnabled.
+ */
+class WorkerPool
+{
+public:
+
+    /** Affinity of the workers. */
+    enum Affinity_e
+    {
+        /** workers are not pinned */
+        AFFINITY_NONE,
+        /** worker i is pinned on the ith allowed core */
+        AFFINITY_CORES,
+        /** worker i is pinned on a core of the NUMA node i modulo the number of nodes */
+        AFFINITY_NUMA
+    };
+
+    /** Get the pool of the process (created at first call).
+     * \return the pool instance. */
+    static WorkerPool& singleton ();
+
+    /** Run a main loop on a worker of the pool.
+     * \param[in] mainloop : the function the worker shall execute
+     * \param[in] data : data provided to the mainloop
+     * \return the thread, to be deleted for giving the worker back to the pool. */
+    IThread* newThread (void* (*mainloop) (void*), void* data);
+
+    /** Get the number of workers created so far.
+     * \return the number of workers. */
+    size_t getNbWorkers ();
+
+    /** Set the affinity of the workers, including the already created ones.
+     * \param[in] affinity : affinity of the workers. */
+    void setAffinity (Affinity_e affinity);
+
+    /** Get the affinity of the workers.
+     * \return the affinity. */
+    Affinity_e getAffinity ();
+
+    /** Tells whether thread groups use the pool or create their own threads (static method).
+     * \param[in] enabled : true for using the pool. */
+    static void setEnabled (bool enabled);
+
+    /** Tells whether thread groups use the pool (static method).
+     * \return true if the pool is used. */
+    static bool isEnabled ();
+
+private:
+
+    WorkerPool ();
+    ~WorkerPool ();
+
+    void* _pool;  // pool_t
+};
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_SYSTEM_IMPL_WORKER_POOL_HPP_ */
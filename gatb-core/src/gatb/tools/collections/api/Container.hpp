@@ -31,6 +31,7 @@
 /********************************************************************************/
 
 #include <gatb/system/api/ISmartPointer.hpp>
+#include <stddef.h>
 
 /********************************************************************************/
 namespace gatb          {
@@ -53,6 +54,16 @@ public:
     /** Tells whether an item exists or not
      * \return true if the item exists, false otherwise */
     virtual bool contains (const Item& item) = 0;
+
+    /** Tells whether each item of an array exists or not. Implementations may override
+     * this method when they can answer faster for many items than for a single one.
+     * \param[in] items : items to test.
+     * \param[in] n : number of items.
+     * \param[out] out : the presence or not of each item (n booleans) */
+    virtual void containsN (const Item* items, size_t n, bool* out)
+    {
+        for (size_t i=0; i<n; i++)  {  out[i] = contains (items[i]);  }
+    }
 };
 
 /********************************************************************************/
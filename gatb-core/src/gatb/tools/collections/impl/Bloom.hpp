@@ -35,6 +35,7 @@
 #include <gatb/system/api/types.hpp>
 #include <gatb/tools/misc/api/Enums.hpp>
 #include <bitset>
+#include <algorithm>
 
 /********************************************************************************/
 namespace gatb          {
@@ -139,6 +140,18 @@ public:
      */
 	virtual bool contains (const Item& item) = 0;
 
+    /** Tells whether each item of an array is in the Bloom filter.
+     * Implementations compute the hash codes of all the items and prefetch the corresponding
+     * parts of the bit set before testing any bit, which hides the memory latency.
+     * \param[in] items : items to test.
+     * \param[in] n : number of items.
+     * \param[out] out : the presence or not of each item (n booleans)
+     */
+    virtual void containsN (const Item* items, size_t n, bool* out)
+    {
+        for (size_t i=0; i<n; i++)  {  out[i] = this->contains (items[i]);  }
+    }
+
     /** Tells whether the 4 neighbors of the given item are in the Bloom filter.
      * The 4 neighbors are computed from the given item by adding successively
      * nucleotides 'A', 'C', 'T' and 'G'
@@ -233,6 +246,38 @@ public:
         return true;
     }
 
+    /** \copydoc IBloom::containsN. */
+    void containsN (const Item* items, size_t n, bool* out)
+    {
+        u_int64_t h0 [BATCH_SIZE];
+
+        for (size_t start=0; start<n; start+=BATCH_SIZE)
+        {
+            size_t nb = std::min (n-start, (size_t)BATCH_SIZE);
+
+            /** We compute the first hash code of each item and prefetch the byte holding it. */
+            for (size_t j=0; j<nb; j++)
+            {
+                h0[j] = isSizePowOf2 ? (_hash (items[start+j],0) & tai) : (_hash (items[start+j],0) % tai);
+                __builtin_prefetch (&(blooma [h0[j] >> 3]), 0, 3);
+            }
+
+            /** We test the bits; other hash codes are computed only for items whose first bit is set. */
+            for (size_t j=0; j<nb; j++)
+            {
+                bool found = (blooma[h0[j] >> 3] & bit_mask[h0[j] & 7]) != 0;
+
+                for (size_t i=1; found && i<n_hash_func; i++)
+                {
+                    u_int64_t h1 = isSizePowOf2 ? (_hash (items[start+j],i) & tai) : (_hash (items[start+j],i) % tai);
+                    found = (blooma[h1 >> 3] & bit_mask[h1 & 7]) != 0;
+                }
+
+                out[start+j] = found;
+            }
+        }
+    }
+
     /** \copydoc IBloom::contains4. */
 	virtual std::bitset<4> contains4 (const Item& item, bool right)
     {   throw system::ExceptionNotImplemented ();  }
@@ -255,6 +300,9 @@ public:
 
 protected:
 
+    /** Number of items whose bits are prefetched together by containsN. */
+    enum { BATCH_SIZE = 32 };
+
     HashFunctors<Item> _hash;
     size_t n_hash_func;
 
@@ -488,6 +536,38 @@ public:
         }
         return true;
     }
+
+    /** \copydoc IBloom::containsN. */
+    void containsN (const Item* items, size_t n, bool* out)
+    {
+        u_int64_t h0 [BloomContainer<Item>::BATCH_SIZE];
+
+        for (size_t start=0; start<n; start+=BloomContainer<Item>::BATCH_SIZE)
+        {
+            size_t nb = std::min (n-start, (size_t)BloomContainer<Item>::BATCH_SIZE);
+
+            /** We compute the block of each item and prefetch it. */
+            for (size_t j=0; j<nb; j++)
+            {
+                h0[j] = this->_hash (items[start+j],0) % _reduced_tai;
+                __builtin_prefetch(&(this->blooma [h0[j] >> 3] ), 0, 3);
+            }
+
+            /** We test the bits, all of them being in the prefetched block. */
+            for (size_t j=0; j<nb; j++)
+            {
+                bool found = (this->blooma[h0[j] >> 3] & bit_mask[h0[j] & 7]) != 0;
+
+                for (size_t i=1; found && i<this->n_hash_func; i++)
+                {
+                    u_int64_t h1 = h0[j] + (simplehash16 (items[start+j], i) & _mask_block);
+                    found = (this->blooma[h1 >> 3] & bit_mask[h1 & 7]) != 0;
+                }
+
+                out[start+j] = found;
+            }
+        }
+    }
     
     /** \copydoc IBloom::weight*/
     unsigned long weight()
@@ -596,29 +676,10 @@ public:
     /** \copydoc Container::contains. */
     bool contains (const Item& item)
     {
-        u_int64_t racine;
-
-        Item suffix = item & 3 ;
-        Item prefix = (item & _prefmask)  >> ((_kmerSize-2)*2);
-        prefix += suffix;
-        prefix = prefix  & 15 ;
-
-        u_int64_t pref_val = cano2[prefix.getVal()]; //get canonical of pref+suffix
-
-        Item hashpart = ( item >> 2 ) & _maskkm2 ;  // delete 1 nt at each side
-        Item rev =  revcomp(hashpart,_kmerSize-2);
-        if(rev<hashpart) hashpart = rev; //transform to canonical
-
-        // Item km = item;
-        // rev =  revcomp(km,_kmerSize);
-        // if(rev < km) km = rev; //transform to canonical
+        Item hashpart;
 
         u_int64_t tab_keys [20];
-        u_int64_t h0;
-
-        racine = ((this->_hash (hashpart,0) ) % this->_reduced_tai) ;
-        //h0 = racine + (this->_hash (km,0)  & this->_mask_block);
-        h0 = racine + (pref_val  );
+        u_int64_t h0 = getFirstKey (item, hashpart);
         //printf("h0 %llu\n",h0);
 
         __builtin_prefetch(&(this->blooma [h0 >> 3] ), 0, 3); //preparing for read
@@ -641,6 +702,39 @@ public:
         return true;
     }
 
+    /** \copydoc IBloom::containsN. */
+    void containsN (const Item* items, size_t n, bool* out)
+    {
+        u_int64_t h0       [BloomContainer<Item>::BATCH_SIZE];
+        Item      hashpart [BloomContainer<Item>::BATCH_SIZE];
+
+        for (size_t start=0; start<n; start+=BloomContainer<Item>::BATCH_SIZE)
+        {
+            size_t nb = std::min (n-start, (size_t)BloomContainer<Item>::BATCH_SIZE);
+
+            /** We compute the block of each item and prefetch it. */
+            for (size_t j=0; j<nb; j++)
+            {
+                h0[j] = getFirstKey (items[start+j], hashpart[j]);
+                __builtin_prefetch(&(this->blooma [h0[j] >> 3] ), 0, 3);
+            }
+
+            /** We test the bits, all of them being in the prefetched block. */
+            for (size_t j=0; j<nb; j++)
+            {
+                bool found = (this->blooma[h0[j] >> 3] & bit_mask[h0[j] & 7]) != 0;
+
+                for (size_t i=1; found && i<this->n_hash_func; i++)
+                {
+                    u_int64_t h1 = h0[j] + (simplehash16 (hashpart[j], i) & this->_mask_block);
+                    found = (this->blooma[h1 >> 3] & bit_mask[h1 & 7]) != 0;
+                }
+
+                out[start+j] = found;
+            }
+        }
+    }
+
     /** \copydoc IBloom::contains4*/
     std::bitset<4> contains4 (const Item& item, bool right)
     {
@@ -815,6 +909,26 @@ private:
     Item _prefmask;
     Item _kmerMask;
     size_t _kmerSize;
+
+    /** Get the first key of an item, ie. the position of its first bit in the bit set.
+     * \param[in] item : the item
+     * \param[out] hashpart : canonical middle part of the item, used for the other keys
+     * \return the first key */
+    u_int64_t getFirstKey (const Item& item, Item& hashpart)
+    {
+        Item suffix = item & 3 ;
+        Item prefix = (item & _prefmask)  >> ((_kmerSize-2)*2);
+        prefix += suffix;
+        prefix = prefix  & 15 ;
+
+        u_int64_t pref_val = cano2[prefix.getVal()]; //get canonical of pref+suffix
+
+        hashpart = ( item >> 2 ) & _maskkm2 ;  // delete 1 nt at each side
+        Item rev =  revcomp(hashpart,_kmerSize-2);
+        if(rev<hashpart) hashpart = rev; //transform to canonical
+
+        return ((this->_hash (hashpart,0) ) % this->_reduced_tai) + pref_val;
+    }
 };
     
 /********************************************************************************/
@@ -911,6 +1025,13 @@ public:
     /** \copydoc IBloom::getBitSize*/
     u_int64_t  getBitSize   ()  { return this->_reduced_tai;    }
 
+    /** \copydoc IBloom::containsN.
+     * Items are tested one by one, since 'contains' reuses the hash codes of the previous item. */
+    void containsN (const Item* items, size_t n, bool* out)
+    {
+        for (size_t i=0; i<n; i++)  {  out[i] = contains (items[i]);  }
+    }
+
     /** \copydoc Container::contains. */
     bool contains (const Item& item, const Item& next = 0)
     {
@@ -1232,6 +1353,216 @@ private:
     }
 };
 	
+/********************************************************************************/
+/** \brief Blocked Bloom filter implementation
+ *
+ * All the bits of an item are in a single block of 512 bits, ie. one 64 bytes CPU cache
+ * line, so a query costs at most one cache miss whatever the number of hash functions.
+ *
+ * The first hash function gives the block; the other ones give the positions (9 bits
+ * each) of the item bits in the block. These bits are gathered in a mask of 8 words that
+ * is set or tested in one shot (the test loop is branchless and can be vectorized).
+ *
+ * For the same size, the false positive rate is a bit higher than for the other
+ * implementations since the blocks are not evenly filled; DebloomAlgorithm::getNbBitsPerKmer
+ * takes this into account.
+ *
+ * The kmer size is needed only for contains4 and contains8, where the neighbors are
+ * computed explicitly.
+ */
+template <typename Item> class BloomBlocked : public IBloom<Item>
+{
+public:
+
+    /** Constructor.
+     * \param[in] tai_bloom : size (in bits) of the bloom filter, rounded up to a number of blocks.
+     * \param[in] nbHash : number of hash functions to use
+     * \param[in] kmersize : kmer size (used only by contains4 and contains8) */
+    BloomBlocked (u_int64_t tai_bloom, size_t nbHash = 4, size_t kmersize = 0)
+        : _hash(1 + (nbHash+NB_POS_PER_HASH-1)/NB_POS_PER_HASH), n_hash_func(nbHash), _raw(0), blooma(0), _nbBlocks(0), _kmerSize(kmersize)
+    {
+        if (n_hash_func > MAX_NB_HASH)  { n_hash_func = MAX_NB_HASH; }
+
+        _nbBlocks = std::max ((tai_bloom + BLOCK_NBITS - 1) / BLOCK_NBITS, (u_int64_t)1);
+
+        /** We align the bit set on a cache line, so each block is exactly one cache line. */
+        _raw   = (u_int8_t*) MALLOC (getSize() + BLOCK_NBYTES);
+        blooma = _raw + (BLOCK_NBYTES - ((uintptr_t)_raw % BLOCK_NBYTES)) % BLOCK_NBYTES;
+        system::impl::System::memory().memset (blooma, 0, getSize());
+
+        if (_kmerSize > 0)
+        {
+            Item un;  un.setVal(1);
+            _kmerMask = (un << (_kmerSize*2)) - un;
+        }
+    }
+
+    /** Destructor. */
+    virtual ~BloomBlocked ()
+    {
+        system::impl::System::memory().free (_raw);
+    }
+
+    /** \copydoc Bag::insert. */
+    void insert (const Item& item)
+    {
+        u_int64_t mask[NB_WORDS];
+        getMask (item, mask);
+
+        u_int64_t* words = (u_int64_t*)blooma + getBlock (item) * NB_WORDS;
+
+        for (size_t w=0; w<NB_WORDS; w++)  {  if (mask[w])  { __sync_fetch_and_or (words + w, mask[w]); }  }
+    }
+
+    /** \copydoc Bag::flush */
+    void flush ()  {}
+
+    /** \copydoc Container::contains. */
+    bool contains (const Item& item)
+    {
+        u_int64_t block = getBlock (item);
+        __builtin_prefetch (blooma + block*BLOCK_NBYTES, 0, 3);
+
+        u_int64_t mask[NB_WORDS];
+        getMask (item, mask);
+
+        return testMask (block, mask);
+    }
+
+    /** \copydoc IBloom::containsN. */
+    void containsN (const Item* items, size_t n, bool* out)
+    {
+        u_int64_t block [BATCH_SIZE];
+        u_int64_t mask  [BATCH_SIZE][NB_WORDS];
+
+        for (size_t start=0; start<n; start+=BATCH_SIZE)
+        {
+            size_t nb = std::min (n-start, (size_t)BATCH_SIZE);
+
+            /** We compute the block of each item and prefetch it. */
+            for (size_t j=0; j<nb; j++)
+            {
+                block[j] = getBlock (items[start+j]);
+                __builtin_prefetch (blooma + block[j]*BLOCK_NBYTES, 0, 3);
+            }
+
+            /** We compute the masks during the prefetch. */
+            for (size_t j=0; j<nb; j++)  {  getMask (items[start+j], mask[j]);  }
+
+            /** We test the masks. */
+            for (size_t j=0; j<nb; j++)  {  out[start+j] = testMask (block[j], mask[j]);  }
+        }
+    }
+
+    /** \copydoc IBloom::contains4. */
+    std::bitset<4> contains4 (const Item& item, bool right)
+    {
+        if (_kmerSize == 0)  { throw system::ExceptionNotImplemented (); }
+
+        /** We compute the 4 neighbors in the same order as BloomNeighborCoherent::contains4. */
+        Item neighbors[4];
+        for (u_int64_t nt=0; nt<4; nt++)
+        {
+            Item single_nt;  single_nt.setVal (nt);
+            Item next = right ? (((item << 2) + single_nt) & _kmerMask) : ((item >> 2) + (single_nt << ((_kmerSize-1)*2)));
+            Item rev  = revcomp (next, _kmerSize);
+            neighbors[nt] = (rev < next) ? rev : next;
+        }
+
+        bool found[4];
+        containsN (neighbors, 4, found);
+
+        std::bitset<4> resu;
+        for (size_t nt=0; nt<4; nt++)  { resu.set (nt, found[nt]); }
+        return resu;
+    }
+
+    /** \copydoc IBloom::contains8. */
+    std::bitset<8> contains8 (const Item& item)
+    {
+        std::bitset<4> resultRight = this->contains4 (item, true);
+        std::bitset<4> resultLeft  = this->contains4 (item, false);
+        std::bitset<8> result;
+        size_t i=0;
+        for (size_t j=0; j<4; j++)  { result.set (i++, resultRight[j]); }
+        for (size_t j=0; j<4; j++)  { result.set (i++, resultLeft [j]); }
+        return result;
+    }
+
+    /** \copydoc IBloom::getArray. */
+    u_int8_t*& getArray    ()  { return blooma; }
+
+    /** \copydoc IBloom::getSize. */
+    u_int64_t  getSize     ()  { return _nbBlocks * BLOCK_NBYTES; }
+
+    /** \copydoc IBloom::getBitSize. */
+    u_int64_t  getBitSize  ()  { return _nbBlocks * BLOCK_NBITS; }
+
+    /** \copydoc IBloom::getNbHash. */
+    size_t     getNbHash   () const { return n_hash_func; }
+
+    /** \copydoc IBloom::getName. */
+    std::string  getName   () const { return "blocked"; }
+
+    /** \copydoc IBloom::weight */
+    unsigned long weight ()
+    {
+        unsigned long weight = 0;
+        for (u_int64_t i=0; i<_nbBlocks*NB_WORDS; i++)  {  weight += __builtin_popcountll (((u_int64_t*)blooma)[i]);  }
+        return weight;
+    }
+
+private:
+
+    /** Block size: one cache line. */
+    enum { BLOCK_NBYTES = 64, BLOCK_NBITS = 8*BLOCK_NBYTES, NB_WORDS = BLOCK_NBYTES/8 };
+
+    /** A 64 bits hash code gives 7 positions of 9 bits in a block. */
+    enum { NB_POS_PER_HASH = 7, MAX_NB_HASH = 9*NB_POS_PER_HASH };
+
+    /** Number of items whose blocks are prefetched together by containsN. */
+    enum { BATCH_SIZE = 32 };
+
+    HashFunctors<Item> _hash;
+    size_t n_hash_func;
+
+    u_int8_t* _raw;
+    u_int8_t* blooma;
+    u_int64_t _nbBlocks;
+
+    size_t _kmerSize;
+    Item   _kmerMask;
+
+    /** Get the block of an item. */
+    u_int64_t getBlock (const Item& item)  {  return _hash (item,0) % _nbBlocks;  }
+
+    /** Compute the bits of an item in its block.
+     * \param[in] item : the item
+     * \param[out] mask : bits of the item in the block */
+    void getMask (const Item& item, u_int64_t* mask)
+    {
+        for (size_t w=0; w<NB_WORDS; w++)  { mask[w] = 0; }
+
+        u_int64_t h = 0;
+        for (size_t i=0; i<n_hash_func; i++)
+        {
+            if (i % NB_POS_PER_HASH == 0)  { h = _hash (item, 1 + i/NB_POS_PER_HASH); }
+            u_int64_t pos = h & (BLOCK_NBITS-1);
+            h >>= 9;
+            mask[pos >> 6] |= (1ULL << (pos & 63));
+        }
+    }
+
+    /** Tells whether all the bits of a mask are set in a block. */
+    bool testMask (u_int64_t block, const u_int64_t* mask) const
+    {
+        const u_int64_t* words = (const u_int64_t*)blooma + block*NB_WORDS;
+        u_int64_t missing = 0;
+        for (size_t w=0; w<NB_WORDS; w++)  { missing |= mask[w] & ~words[w]; }
+        return missing == 0;
+    }
+};
+
 /********************************************************************************/
 
 /** \brief Factory that creates IBloom instances
@@ -1259,6 +1590,7 @@ public:
             case tools::misc::BLOOM_BASIC:     return new BloomSynchronized<T>     (tai_bloom, nbHash);
             case tools::misc::BLOOM_CACHE:     return new BloomCacheCoherent<T>    (tai_bloom, nbHash);
 			case tools::misc::BLOOM_NEIGHBOR:  return new BloomNeighborCoherent<T> (tai_bloom, kmersize, nbHash);
+            case tools::misc::BLOOM_BLOCKED:   return new BloomBlocked<T>          (tai_bloom, nbHash, kmersize);
             case tools::misc::BLOOM_DEFAULT:   return new BloomCacheCoherent<T>    (tai_bloom, nbHash);
             default:        throw system::Exception ("bad Bloom kind %d in createBloom", kind);
         }
@@ -280,15 +280,30 @@ public:
 
         size_t nbElts = iterable->getNbItems();
 
-        iterator_wrapper kmers (iter); 
-
 		bool withprogress = true;
 
 		if (progress==0)
 			withprogress = false;
-		
 
-        bphf =  boophf_t(nbElts, kmers, nbThreads, 3.0 /*much faster construction than gamma=1*/, withprogress);
+        /** If the iterator is made of independent parts (the partitions of the solid kmers for instance),
+         * the threads read the parts concurrently instead of sharing a single iterator. */
+        std::vector<tools::dp::Iterator<Key>*> parts = iter->getComposition();
+
+        if (parts.size() > 1)
+        {
+            std::vector<iterator_wrapper> ranges;
+            for (size_t i=0; i<parts.size(); i++)  {  parts[i]->use();  ranges.push_back (iterator_wrapper (parts[i]));  }
+
+            bphf =  boophf_t(nbElts, boomphf::multi_range<iterator_wrapper> (ranges), nbThreads, 3.0 /*much faster construction than gamma=1*/, withprogress);
+
+            for (size_t i=0; i<parts.size(); i++)  {  parts[i]->forget();  }
+        }
+        else
+        {
+            iterator_wrapper kmers (iter);
+
+            bphf =  boophf_t(nbElts, kmers, nbThreads, 3.0 /*much faster construction than gamma=1*/, withprogress);
+        }
 
         isBuilt = true;
         nbKeys  = iterable->getNbItems();
@@ -342,7 +357,12 @@ private:
     public:
         iterator_adaptator()  : iterator(0), pos(0) {}
 
-        iterator_adaptator(tools::dp::Iterator<Key>* iterator)  : iterator(iterator), pos(0)  {  iterator->first();  }
+        iterator_adaptator(tools::dp::Iterator<Key>* iterator)  : iterator(iterator), pos(0)
+        {
+            iterator->first();
+            /** An empty iterator (an empty partition for instance) is already at the end. */
+            if (iterator->isDone())  {  this->iterator = nullptr;  }
+        }
 
         Key const& operator*()  {  return iterator->item();  }
 
@@ -0,0 +1,322 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file FlatHash.hpp
+ *  \brief Open addressing counting hash table with groups of control bytes
+ */
+
+#ifndef _GATB_CORE_TOOLS_COLLECTIONS_IMPL_FLAT_HASH_HPP_
+#define _GATB_CORE_TOOLS_COLLECTIONS_IMPL_FLAT_HASH_HPP_
+
+/********************************************************************************/
+
+#include <gatb/tools/designpattern/api/Iterator.hpp>
+#include <gatb/system/impl/System.hpp>
+
+#include <algorithm>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/********************************************************************************/
+namespace gatb          {
+namespace core          {
+namespace tools         {
+namespace collections   {
+namespace impl          {
+/********************************************************************************/
+
+/** \brief Counting hash table with open addressing.
+ *
+ * The cells are stored in a flat array split in groups of 16 cells. Each cell has a
+ * control byte holding 7 bits of the hash of its key (or EMPTY), so a lookup loads the
+ * 16 control bytes of a group, compares them to the key fingerprint at once (SSE2 when
+ * available) and only compares the keys of the matching cells. Groups are probed
+ * linearly; since no item is ever removed, a group with an empty cell ends the probe.
+ *
+ * The table doubles its size when it is 7/8 full, up to the memory given to the
+ * constructor; then isFull tells the caller to dump and clear the table. Since the caller
+ * checks it only from time to time, the last size is filled up to 15/16 before growing
+ * beyond the limit. getByteSize gives the memory actually allocated; clear releases it
+ * back to the initial size.
+ *
+ * It is meant to replace Hash16 for counting kmers: the 'cell' type has the same
+ * 'graine' and 'val' fields, and the sorted iterator also reorders the table in place
+ * (the table can't be used afterwards until it is cleared).
+ */
+template <typename Item, typename value_type=int> class FlatHash
+{
+public:
+
+    struct cell
+    {
+        Item       graine;
+        value_type val;
+    };
+
+    /** Constructor.
+     * \param[in] sizeMB : approx max memory to be used by the hash table; the initial
+     * table uses a fraction of it and grows on demand. */
+    FlatHash (size_t sizeMB) : _ctrl(0), _cells(0), _nbGroups(0), _nbGroupsInit(1), _nbGroupsMax(1), _nbElem(0), _maxNbElem(0)
+    {
+        /** We start with about 1/8 of the memory, rounded to a power of two number of groups. */
+        u_int64_t nbBytes = (u_int64_t)sizeMB*1024LL*1024LL;
+        while (2*_nbGroupsMax*GROUP_SIZE*(sizeof(cell)+1) <= nbBytes)  {  _nbGroupsMax *= 2;  }
+        _nbGroupsInit = std::max ((u_int64_t)1, _nbGroupsMax/8);
+
+        allocate (_nbGroupsInit);
+    }
+
+    /** Destructor */
+    ~FlatHash ()
+    {
+        FREE (_ctrl);
+        FREE (_cells);
+    }
+
+    /** Get the memory used by the hash table.
+     * \return the memory size (in bytes) */
+    u_int64_t getByteSize ()  {  return _nbGroups * GROUP_SIZE * (sizeof(cell) + 1);  }
+
+    /** Get the number of items in the hash table
+     * \return the number of items. */
+    u_int64_t size ()  { return _nbElem; }
+
+    /** Tells whether the table has reached the memory limit and should be emptied.
+     * \return true if full, false otherwise. */
+    bool isFull ()  {  return _nbGroups >= _nbGroupsMax && _nbElem > _nbGroups * GROUP_SIZE / 8 * 7;  }
+
+    /** Clear the content of the hash table. */
+    void clear ()
+    {
+        if (_nbGroups != _nbGroupsInit)
+        {
+            FREE (_ctrl);
+            FREE (_cells);
+            allocate (_nbGroupsInit);
+        }
+        else
+        {
+            memset (_ctrl, EMPTY, _nbGroups*GROUP_SIZE);
+            _nbElem = 0;
+        }
+    }
+
+    /** Increment the value of a key, inserting it with value 1 if needed.
+     * \param[in] graine : key
+     */
+    void insert (const Item& graine)
+    {
+        u_int64_t h     = hash1 (graine, 0);
+        u_int8_t  h2    = h & 0x7F;
+        u_int64_t mask  = _nbGroups - 1;
+
+        for (u_int64_t g = (h >> 7) & mask; ; g = (g+1) & mask)
+        {
+            u_int8_t* ctrl  = _ctrl  + g*GROUP_SIZE;
+            cell*     cells = _cells + g*GROUP_SIZE;
+
+            for (u_int32_t m = match (ctrl, h2); m != 0; m &= m-1)
+            {
+                cell& c = cells[__builtin_ctz(m)];
+                if (c.graine == graine)  {  c.val++;  return;  }
+            }
+
+            u_int32_t e = match (ctrl, EMPTY);
+            if (e != 0)
+            {
+                size_t i = __builtin_ctz(e);
+                ctrl[i]         = h2;
+                cells[i].graine = graine;
+                cells[i].val    = 1;
+
+                if (++_nbElem > _maxNbElem)  {  grow();  }
+                return;
+            }
+        }
+    }
+
+    /** Get the value for a given key
+     * \param[in] graine : key
+     * \param[out] val : value to be retrieved
+     * \return true if the key exists, false otherwise.
+     */
+    bool get (const Item& graine, value_type* val=0)
+    {
+        u_int64_t h     = hash1 (graine, 0);
+        u_int8_t  h2    = h & 0x7F;
+        u_int64_t mask  = _nbGroups - 1;
+
+        for (u_int64_t g = (h >> 7) & mask; ; g = (g+1) & mask)
+        {
+            u_int8_t* ctrl  = _ctrl  + g*GROUP_SIZE;
+            cell*     cells = _cells + g*GROUP_SIZE;
+
+            for (u_int32_t m = match (ctrl, h2); m != 0; m &= m-1)
+            {
+                cell& c = cells[__builtin_ctz(m)];
+                if (c.graine == graine)  {  if (val != 0)  { *val = c.val; }  return true;  }
+            }
+
+            if (match (ctrl, EMPTY) != 0)  {  return false;  }
+        }
+    }
+
+    static bool sortByKey (const cell& lhs, const cell& rhs) { return lhs.graine < rhs.graine; }
+
+    /** Get an iterator for the hash table.
+     * \param[in] sorted : if true, items are iterated in a sorted way (warning: reorder in place so cant acces hash after that !)
+     * \return an iterator over the items of the hash table.
+     */
+    dp::Iterator<cell>* iterator (bool sorted=false)
+    {
+        if (sorted)
+        {
+            /** We move the items at the beginning of the table and sort them. */
+            u_int64_t nb = 0;
+            for (u_int64_t i=0; i<_nbGroups*GROUP_SIZE; i++)
+            {
+                if (_ctrl[i] != EMPTY)  {  _cells[nb++] = _cells[i];  }
+            }
+            std::sort (_cells, _cells + nb, sortByKey);
+
+            memset (_ctrl,      0,     nb);
+            memset (_ctrl + nb, EMPTY, _nbGroups*GROUP_SIZE - nb);
+        }
+
+        return new Iterator (*this);
+    }
+
+    /************************************************************/
+    class Iterator : public dp::Iterator<cell>
+    {
+    public:
+
+        Iterator (FlatHash& aRef) : _ref(aRef), _idx(0), _done(true)  {}
+
+        /** \copydoc tools::dp::Iterator::first */
+        void first()  {  _idx = (u_int64_t)-1;  _done = false;  next();  }
+
+        /** \copydoc tools::dp::Iterator::next */
+        void next()
+        {
+            u_int64_t nb = _ref._nbGroups * GROUP_SIZE;
+            for (++_idx; _idx < nb && _ref._ctrl[_idx] == EMPTY; ++_idx)  {}
+
+            _done = _idx >= nb;
+            if (!_done)  {  *this->_item = _ref._cells[_idx];  }
+        }
+
+        /** \copydoc tools::dp::Iterator::isDone */
+        bool isDone ()  {  return _done;  }
+
+        /** \copydoc tools::dp::Iterator::item */
+        cell& item ()  {  return *this->_item;  }
+
+    private:
+        FlatHash& _ref;
+        u_int64_t _idx;
+        bool      _done;
+    };
+
+private:
+
+    static const size_t   GROUP_SIZE = 16;
+    static const u_int8_t EMPTY      = 0x80;
+
+    u_int8_t* _ctrl;
+    cell*     _cells;
+    u_int64_t _nbGroups;
+    u_int64_t _nbGroupsInit;
+    u_int64_t _nbGroupsMax;
+    u_int64_t _nbElem;
+    u_int64_t _maxNbElem;
+
+    /** Get the cells of a group whose control byte is the given one.
+     * \return a bit mask, bit i set for the cell i of the group. */
+    static u_int32_t match (const u_int8_t* ctrl, u_int8_t value)
+    {
+#ifdef __SSE2__
+        __m128i group = _mm_loadu_si128 ((const __m128i*) ctrl);
+        return _mm_movemask_epi8 (_mm_cmpeq_epi8 (group, _mm_set1_epi8 (value)));
+#else
+        u_int32_t result = 0;
+        for (size_t i=0; i<GROUP_SIZE; i++)  {  result |= (u_int32_t)(ctrl[i] == value) << i;  }
+        return result;
+#endif
+    }
+
+    void allocate (u_int64_t nbGroups)
+    {
+        _nbGroups  = nbGroups;
+        _nbElem    = 0;
+        _maxNbElem = _nbGroups < _nbGroupsMax ? _nbGroups * GROUP_SIZE / 8 * 7 : _nbGroups * GROUP_SIZE / 16 * 15;
+        _ctrl      = (u_int8_t*) MALLOC (_nbGroups * GROUP_SIZE);
+        _cells     = (cell*)     MALLOC (_nbGroups * GROUP_SIZE * sizeof(cell));
+
+        if (_ctrl==0 || _cells==0)  {  throw system::Exception ("FlatHash: unable to allocate %lld groups", (long long) _nbGroups);  }
+
+        memset (_ctrl, EMPTY, _nbGroups * GROUP_SIZE);
+    }
+
+    /** Double the size of the table and reinsert the items (which are known to be distinct). */
+    void grow ()
+    {
+        u_int8_t* oldCtrl  = _ctrl;
+        cell*     oldCells = _cells;
+        u_int64_t oldNb    = _nbGroups * GROUP_SIZE;
+        u_int64_t nbElem   = _nbElem;
+
+        allocate (2*_nbGroups);
+
+        u_int64_t mask = _nbGroups - 1;
+
+        for (u_int64_t i=0; i<oldNb; i++)
+        {
+            if (oldCtrl[i] == EMPTY)  { continue; }
+
+            u_int64_t h = hash1 (oldCells[i].graine, 0);
+
+            for (u_int64_t g = (h >> 7) & mask; ; g = (g+1) & mask)
+            {
+                u_int32_t e = match (_ctrl + g*GROUP_SIZE, EMPTY);
+                if (e != 0)
+                {
+                    size_t j = g*GROUP_SIZE + __builtin_ctz(e);
+                    _ctrl [j] = h & 0x7F;
+                    _cells[j] = oldCells[i];
+                    break;
+                }
+            }
+        }
+
+        _nbElem = nbElem;
+
+        FREE (oldCtrl);
+        FREE (oldCells);
+    }
+};
+
+/********************************************************************************/
+} } } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_TOOLS_COLLECTIONS_IMPL_FLAT_HASH_HPP_ */
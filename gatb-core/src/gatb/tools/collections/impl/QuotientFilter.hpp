@@ -0,0 +1,534 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file QuotientFilter.hpp
+ *  \brief Counting quotient filter implementation
+ */
+
+#ifndef _GATB_CORE_TOOLS_COLLECTIONS_IMPL_QUOTIENT_FILTER_HPP_
+#define _GATB_CORE_TOOLS_COLLECTIONS_IMPL_QUOTIENT_FILTER_HPP_
+
+/********************************************************************************/
+
+#include <gatb/tools/collections/api/Container.hpp>
+#include <gatb/tools/collections/api/Bag.hpp>
+#include <gatb/tools/math/LargeInt.hpp>
+#include <gatb/system/impl/System.hpp>
+#include <gatb/system/api/types.hpp>
+#include <vector>
+#include <algorithm>
+
+/********************************************************************************/
+namespace gatb          {
+namespace core          {
+namespace tools         {
+namespace collections   {
+namespace impl          {
+/********************************************************************************/
+
+/** \brief Counting quotient filter (rank/select flavour)
+ *
+ * Each item is hashed into a fingerprint of q+r bits: the q high bits (the quotient)
+ * give the home slot of the item and the r low bits (the remainder) are stored in the
+ * slot, together with a small saturating counter. Items having the same quotient are
+ * stored as a sorted run; a run starts at its home slot or just after the previous run.
+ *
+ * The slots are grouped by blocks of 64; each block holds:
+ *   - the 'occupieds' bits: bit i is set if some item has the quotient 64b+i
+ *   - the 'runends' bits: bit i is set if the slot 64b+i is the last slot of a run
+ *   - the offset: number of slots from the start of the block used by runs of the
+ *     previous blocks
+ * so the run of a quotient is found with one rank (on occupieds) and one select (on
+ * runends), most of the time inside a single block. The metadata and the slots of a
+ * block are contiguous in memory.
+ *
+ * Compared to a Bloom filter, the answer is exact up to fingerprint collisions (about
+ * load/2^r false positives per query), the count of an item can be retrieved and items
+ * can be removed. Removing an item decrements its counter; a zero counter is a
+ * tombstone that is dropped at the next resize.
+ *
+ * The filter doubles its number of slots when it is too loaded; one remainder bit then
+ * goes to the quotient, so the false positive rate doubles at each resize. The initial
+ * number of quotient bits should be computed with computeQuotientBits when the number of
+ * items is known.
+ *
+ * Insertions are not thread safe; queries are.
+ */
+template <typename Item> class QuotientFilter : public Container<Item>, public Bag<Item>, public system::SmartPointer
+{
+public:
+
+    /** Constructor.
+     * \param[in] quotientBits : number of bits of the quotient (the filter has 2^quotientBits slots)
+     * \param[in] remainderBits : number of bits of the remainder
+     * \param[in] counterBits : number of bits of the counters
+     * \param[in] seed : seed of the hash function */
+    QuotientFilter (size_t quotientBits, size_t remainderBits=24, size_t counterBits=8, u_int64_t seed=0)
+        : _seed(seed), _nbUsed(0)
+    {
+        if (remainderBits == 0 || counterBits == 0 || remainderBits + counterBits > 64 || quotientBits + remainderBits > 64 || quotientBits > 48)
+        {
+            throw system::Exception ("bad quotient filter configuration (q=%d r=%d c=%d)", (int)quotientBits, (int)remainderBits, (int)counterBits);
+        }
+
+        configure (quotientBits, remainderBits, counterBits);
+    }
+
+    /** Get the number of quotient bits needed for holding some items without resizing (static method).
+     * \param[in] nbItems : number of items to be inserted
+     * \return the number of quotient bits. */
+    static size_t computeQuotientBits (u_int64_t nbItems)
+    {
+        size_t q = 6;
+        while ( (((u_int64_t)1 << q) * MAX_LOAD_PERCENT) / 100 < nbItems)  { q++; }
+        return q;
+    }
+
+    /** \copydoc Bag::insert. */
+    void insert (const Item& item)  {  add (item, 1);  }
+
+    /** \copydoc Bag::flush. */
+    void flush ()  {}
+
+    /** Add some occurrences of an item; the counter of the item saturates at 2^counterBits-1.
+     * \param[in] item : the item
+     * \param[in] count : number of occurrences */
+    void add (const Item& item, u_int64_t count)
+    {
+        if (count == 0)  { return; }
+
+        u_int64_t fp = getFingerprint (item);
+
+        /** We resize the filter if it is too loaded. */
+        if ((_nbUsed+1)*100 > _nbQuotients*MAX_LOAD_PERCENT)  {  resize ();  }
+
+        /** We may also resize if a cluster reaches the end of the slots (the fingerprint doesn't change). */
+        while (addFingerprint (fp, count) == false)  {  resize ();  }
+    }
+
+    /** Remove some occurrences of an item.
+     * \param[in] item : the item
+     * \param[in] count : number of occurrences
+     * \return false if the item was not in the filter. */
+    bool remove (const Item& item, u_int64_t count=1)
+    {
+        u_int64_t fp = getFingerprint (item);
+        int64_t   pos = findSlot (fp);
+        if (pos < 0)  { return false; }
+
+        u_int64_t value = getSlot (pos);
+        u_int64_t nb    = value & _counterMax;
+        if (nb == 0)  { return false; }
+
+        nb = count >= nb ? 0 : nb - count;
+        setSlot (pos, (value & ~_counterMax) | nb);
+        return true;
+    }
+
+    /** \copydoc Container::contains. */
+    bool contains (const Item& item)  {  return getCount (item) > 0;  }
+
+    /** \copydoc Container::containsN
+     * The metadata and home slots of a batch of items are prefetched before the items are looked for. */
+    void containsN (const Item* items, size_t n, bool* out)
+    {
+        u_int64_t fp[BATCH_SIZE];
+
+        for (size_t start=0; start<n; start+=BATCH_SIZE)
+        {
+            size_t nb = std::min ((size_t)BATCH_SIZE, n-start);
+
+            for (size_t j=0; j<nb; j++)
+            {
+                fp[j] = getFingerprint (items[start+j]);
+
+                u_int64_t  x     = fp[j] >> _r;
+                u_int64_t* block = getBlock (x >> 6);
+                __builtin_prefetch (block, 0, 1);
+                __builtin_prefetch (block + NB_META_WORDS + (((x & 63) * _slotBits) >> 6), 0, 1);
+            }
+
+            for (size_t j=0; j<nb; j++)  {  out[start+j] = getCountFingerprint (fp[j]) > 0;  }
+        }
+    }
+
+    /** Get the number of occurrences of an item.
+     * \param[in] item : the item
+     * \return the counter of the item (0 if not found). */
+    u_int64_t getCount (const Item& item) const  {  return getCountFingerprint (getFingerprint (item));  }
+
+    /** Double the number of slots of the filter. */
+    void resize ()
+    {
+        if (_r <= 1)  { throw system::Exception ("unable to resize quotient filter (q=%d r=%d)", (int)_q, (int)_r); }
+
+        QuotientFilter other (_q+1, _r-1, _c, _seed);
+
+        /** We insert the fingerprints into the new filter; tombstones are dropped. */
+        iterate ([&other] (u_int64_t fp, u_int64_t count)
+        {
+            if (count > 0 && other.addFingerprint (fp, count) == false)  {  throw system::Exception ("unable to resize quotient filter");  }
+        });
+
+        swap (other);
+    }
+
+    /** Iterate the fingerprints of the filter, in increasing order.
+     * \param[in] fct : functor called with the fingerprint and the counter of each slot (the counter may be 0). */
+    template<typename Functor> void iterate (Functor fct) const
+    {
+        int64_t prevEnd = -1;
+
+        for (u_int64_t b=0; b<_nbBlocks; b++)
+        {
+            for (u_int64_t occ = getBlock(b)[OCCUPIEDS]; occ != 0; occ &= occ-1)
+            {
+                u_int64_t x = (b << 6) + __builtin_ctzll (occ);
+                u_int64_t p = std::max ((int64_t)x, prevEnd+1);
+
+                for ( ; ; p++)
+                {
+                    u_int64_t value = getSlot (p);
+                    fct ((x << _r) | (value >> _c), value & _counterMax);
+                    if (isRunend (p))  { break; }
+                }
+
+                prevEnd = p;
+            }
+        }
+    }
+
+    /** Get the number of used slots (including tombstones).
+     * \return the number of used slots. */
+    u_int64_t getNbItems () const  { return _nbUsed; }
+
+    /** Set the number of used slots, for a filter whose data has been loaded.
+     * \param[in] nbItems : number of used slots */
+    void setNbItems (u_int64_t nbItems)  { _nbUsed = nbItems; }
+
+    /** Get the number of slots addressed by the quotients.
+     * \return the number of slots */
+    u_int64_t getNbSlots () const  { return _nbQuotients; }
+
+    /** Get the load factor of the filter.
+     * \return the load factor. */
+    float getLoad () const  { return (float)_nbUsed / (float)_nbQuotients; }
+
+    /** Get the number of bits of the quotient.
+     * \return the number of bits */
+    size_t getQuotientBits () const  { return _q; }
+
+    /** Get the number of bits of the remainder.
+     * \return the number of bits */
+    size_t getRemainderBits () const  { return _r; }
+
+    /** Get the number of bits of the counters.
+     * \return the number of bits */
+    size_t getCounterBits () const  { return _c; }
+
+    /** Get the seed of the hash function.
+     * \return the seed */
+    u_int64_t getSeed () const  { return _seed; }
+
+    /** Get the size of the filter data in bytes.
+     * \return the size. */
+    u_int64_t getSize () const  { return _data.size() * sizeof(u_int64_t); }
+
+    /** Get the filter data (for saving and loading it).
+     * \return the data. */
+    u_int64_t* getArray ()  { return _data.data(); }
+
+private:
+
+    /** Maximum load factor (in percent) before resizing. */
+    enum { MAX_LOAD_PERCENT = 90 };
+
+    /** Index of the metadata words in a block. */
+    enum { OFFSET = 0, OCCUPIEDS = 1, RUNENDS = 2, NB_META_WORDS = 3 };
+
+    /** Number of items prefetched together in containsN. */
+    enum { BATCH_SIZE = 32 };
+
+    size_t    _q;
+    size_t    _r;
+    size_t    _c;
+    size_t    _slotBits;
+    u_int64_t _seed;
+
+    u_int64_t _nbQuotients;
+    u_int64_t _nbSlots;      // including the overflow slots after the last quotient
+    u_int64_t _nbBlocks;
+    u_int64_t _blockWords;
+    u_int64_t _nbUsed;
+
+    u_int64_t _fpMask;
+    u_int64_t _remMask;
+    u_int64_t _slotMask;
+    u_int64_t _counterMax;
+
+    std::vector<u_int64_t> _data;
+
+    /** */
+    static u_int64_t lowMask (size_t nbits)  { return nbits >= 64 ? ~(u_int64_t)0 : ((u_int64_t)1 << nbits) - 1; }
+
+    /** Position of the (k+1)th set bit of a word. */
+    static u_int64_t select64 (u_int64_t word, u_int64_t k)
+    {
+        for (u_int64_t i=0; i<k; i++)  { word &= word - 1; }
+        return __builtin_ctzll (word);
+    }
+
+    /** */
+    void configure (size_t q, size_t r, size_t c)
+    {
+        _q = q;  _r = r;  _c = c;  _slotBits = r + c;
+
+        _nbQuotients = (u_int64_t)1 << q;
+
+        /** Runs may go beyond the last quotient, so we add some overflow slots. */
+        u_int64_t nbExtra = std::max ((u_int64_t)128, _nbQuotients / 16);
+        _nbSlots    = ((_nbQuotients + nbExtra + 63) / 64) * 64;
+        _nbBlocks   = _nbSlots / 64;
+        _blockWords = NB_META_WORDS + _slotBits;
+
+        _fpMask     = lowMask (q + r);
+        _remMask    = lowMask (r);
+        _slotMask   = lowMask (_slotBits);
+        _counterMax = lowMask (c);
+
+        _data.assign (_nbBlocks * _blockWords, 0);
+    }
+
+    /** */
+    void swap (QuotientFilter& other)
+    {
+        std::swap (_q,          other._q);
+        std::swap (_r,          other._r);
+        std::swap (_c,          other._c);
+        std::swap (_slotBits,   other._slotBits);
+        std::swap (_seed,       other._seed);
+        std::swap (_nbQuotients,other._nbQuotients);
+        std::swap (_nbSlots,    other._nbSlots);
+        std::swap (_nbBlocks,   other._nbBlocks);
+        std::swap (_blockWords, other._blockWords);
+        std::swap (_nbUsed,     other._nbUsed);
+        std::swap (_fpMask,     other._fpMask);
+        std::swap (_remMask,    other._remMask);
+        std::swap (_slotMask,   other._slotMask);
+        std::swap (_counterMax, other._counterMax);
+        _data.swap (other._data);
+    }
+
+    /** */
+    u_int64_t getFingerprint (const Item& item) const  {  return hash1 (item, _seed) & _fpMask;  }
+
+    /** */
+    u_int64_t*       getBlock (u_int64_t b)        { return _data.data() + b * _blockWords; }
+    const u_int64_t* getBlock (u_int64_t b) const  { return _data.data() + b * _blockWords; }
+
+    /** */
+    bool isOccupied (u_int64_t x) const  { return (getBlock(x >> 6)[OCCUPIEDS] >> (x & 63)) & 1; }
+    bool isRunend   (u_int64_t p) const  { return (getBlock(p >> 6)[RUNENDS]   >> (p & 63)) & 1; }
+
+    void setOccupied (u_int64_t x)  {  getBlock(x >> 6)[OCCUPIEDS] |= (u_int64_t)1 << (x & 63);  }
+
+    void setRunend (u_int64_t p, bool value)
+    {
+        u_int64_t& word = getBlock(p >> 6)[RUNENDS];
+        if (value)  { word |=  ((u_int64_t)1 << (p & 63)); }
+        else        { word &= ~((u_int64_t)1 << (p & 63)); }
+    }
+
+    /** A slot holds the remainder in its high bits and the counter in its low bits. */
+    u_int64_t getSlot (u_int64_t p) const
+    {
+        const u_int64_t* slots = getBlock(p >> 6) + NB_META_WORDS;
+        u_int64_t bit = (p & 63) * _slotBits;
+        u_int64_t w   = bit >> 6;
+        u_int64_t s   = bit & 63;
+
+        u_int64_t value = slots[w] >> s;
+        if (s + _slotBits > 64)  { value |= slots[w+1] << (64 - s); }
+        return value & _slotMask;
+    }
+
+    /** */
+    void setSlot (u_int64_t p, u_int64_t value)
+    {
+        u_int64_t* slots = getBlock(p >> 6) + NB_META_WORDS;
+        u_int64_t bit = (p & 63) * _slotBits;
+        u_int64_t w   = bit >> 6;
+        u_int64_t s   = bit & 63;
+
+        slots[w] = (slots[w] & ~(_slotMask << s)) | (value << s);
+        if (s + _slotBits > 64)
+        {
+            size_t hi = 64 - s;
+            slots[w+1] = (slots[w+1] & ~(_slotMask >> hi)) | (value >> hi);
+        }
+    }
+
+    /** Position of the dth runend (d>0) from a given position. */
+    u_int64_t selectRunend (u_int64_t from, u_int64_t d) const
+    {
+        u_int64_t b    = from >> 6;
+        u_int64_t word = getBlock(b)[RUNENDS] & (~(u_int64_t)0 << (from & 63));
+
+        for (;;)
+        {
+            u_int64_t nb = __builtin_popcountll (word);
+            if (nb >= d)  { return (b << 6) + select64 (word, d-1); }
+
+            d -= nb;
+            if (++b >= _nbBlocks)  { throw system::Exception ("corrupted quotient filter"); }
+            word = getBlock(b)[RUNENDS];
+        }
+    }
+
+    /** Last slot used by the runs of the quotients <= x; may be before x (or -1). */
+    int64_t getRunEnd (u_int64_t x) const
+    {
+        const u_int64_t* block = getBlock (x >> 6);
+
+        u_int64_t d     = __builtin_popcountll (block[OCCUPIEDS] & lowMask ((x & 63) + 1));
+        u_int64_t start = (x & ~(u_int64_t)63) + block[OFFSET];
+
+        if (d == 0)  { return (int64_t)start - 1; }
+        return selectRunend (start, d);
+    }
+
+    /** First slot of the run of an occupied quotient, given the end of the run. */
+    u_int64_t getRunStart (u_int64_t x, u_int64_t end) const
+    {
+        u_int64_t p = end;
+        while (p > x && !isRunend (p-1))  { p--; }
+        return p;
+    }
+
+    /** First unused slot from a given position (_nbSlots if none). */
+    u_int64_t findFirstUnused (u_int64_t from) const
+    {
+        while (from < _nbSlots)
+        {
+            int64_t end = getRunEnd (from);
+            if (end < (int64_t)from)  { return from; }
+            from = end + 1;
+        }
+        return _nbSlots;
+    }
+
+    /** Position of the slot of a fingerprint, or -1 if not found. */
+    int64_t findSlot (u_int64_t fp) const
+    {
+        u_int64_t x   = fp >> _r;
+        u_int64_t rem = fp & _remMask;
+
+        if (!isOccupied (x))  { return -1; }
+
+        u_int64_t end = getRunEnd (x);
+
+        /** Remainders are sorted in a run, so we scan it backwards from its end. */
+        for (u_int64_t p = end; ; p--)
+        {
+            u_int64_t r = getSlot(p) >> _c;
+            if (r == rem)  { return p; }
+            if (r <  rem || p == x || isRunend (p-1))  { return -1; }
+        }
+    }
+
+    /** */
+    u_int64_t getCountFingerprint (u_int64_t fp) const
+    {
+        int64_t pos = findSlot (fp);
+        return pos < 0 ? 0 : getSlot (pos) & _counterMax;
+    }
+
+    /** Add a fingerprint; returns false if there is no more room at the end of the slots. */
+    bool addFingerprint (u_int64_t fp, u_int64_t count)
+    {
+        u_int64_t x   = fp >> _r;
+        u_int64_t rem = fp & _remMask;
+
+        if (!isOccupied (x))
+        {
+            /** We create a new run of one slot. */
+            u_int64_t pos = std::max ((int64_t)x, getRunEnd (x) + 1);
+            return insertSlot (x, pos, (rem << _c) | std::min (count, _counterMax), RUN_NEW);
+        }
+
+        u_int64_t end = getRunEnd   (x);
+        u_int64_t pos = getRunStart (x, end);
+
+        for ( ; pos <= end; pos++)
+        {
+            u_int64_t value = getSlot (pos);
+            u_int64_t r     = value >> _c;
+
+            if (r == rem)
+            {
+                /** The fingerprint is already here, we increase its counter. */
+                u_int64_t nb = value & _counterMax;
+                nb = (count >= _counterMax - nb) ? _counterMax : nb + count;
+                setSlot (pos, (rem << _c) | nb);
+                return true;
+            }
+            if (r > rem)  { break; }
+        }
+
+        return insertSlot (x, pos, (rem << _c) | std::min (count, _counterMax), pos > end ? RUN_APPEND : RUN_INSIDE);
+    }
+
+    enum InsertMode { RUN_NEW, RUN_APPEND, RUN_INSIDE };
+
+    /** Insert a slot value at some position of the run of x, the next slots being shifted. */
+    bool insertSlot (u_int64_t x, u_int64_t pos, u_int64_t value, InsertMode mode)
+    {
+        u_int64_t empty = findFirstUnused (pos);
+        if (empty >= _nbSlots)  { return false; }
+
+        /** We shift the slots [pos,empty[ by one slot. */
+        for (u_int64_t p=empty; p>pos; p--)
+        {
+            setSlot   (p, getSlot  (p-1));
+            setRunend (p, isRunend (p-1));
+        }
+
+        setSlot (pos, value);
+
+        switch (mode)
+        {
+            case RUN_NEW:     setRunend (pos, true);   setOccupied (x);             break;
+            case RUN_APPEND:  setRunend (pos-1, false);  setRunend (pos, true);     break;
+            case RUN_INSIDE:  setRunend (pos, false);                               break;
+        }
+
+        /** The blocks starting in ]x,empty] have one more slot used by the runs of previous blocks:
+         * either the inserted item itself or an item shifted from the previous block. */
+        for (u_int64_t b = (x >> 6) + 1;  b < _nbBlocks && (b << 6) <= empty;  b++)  {  getBlock(b)[OFFSET] ++;  }
+
+        _nbUsed ++;
+        return true;
+    }
+};
+
+/********************************************************************************/
+} } } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_TOOLS_COLLECTIONS_IMPL_QUOTIENT_FILTER_HPP_ */
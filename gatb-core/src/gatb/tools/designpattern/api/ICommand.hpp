@@ -33,8 +33,10 @@
 #include <gatb/system/api/IThread.hpp>
 #include <gatb/system/impl/System.hpp>
 #include <gatb/tools/designpattern/api/Iterator.hpp>
+#include <gatb/tools/designpattern/impl/IteratorHelpers.hpp>
 
 #include <vector>
+#include <algorithm>
 
 /********************************************************************************/
 namespace gatb  {
@@ -222,6 +224,115 @@ public:
         return status;
     }
 
+    /** Iterate a range of indexes without any shared lock. The range is split in as many shards as execution
+     * units; each thread takes groups of indexes from its own shard and, once its shard is exhausted, steals
+     * groups of indexes from the other shards. The provided functor is cloned N times, one per thread, and is
+     * called with each index of the range.
+     *
+     * This is the way to go for sources whose items can be accessed by index (vectors, partitions, blocks
+     * of a bank, ranges of a MPHF...), since the threads don't contend on a single synchronizer.
+     *
+     * Note that the group size of the dispatcher (see setGroupSize) doesn't overwrite the provided one.
+     *
+     * \param[in] begin : first index of the range
+     * \param[in] end : last index (excluded) of the range
+     * \param[in] functor : functor object to be cloned N times, one per thread; called with a u_int64_t index.
+     * \param[in] groupSize : number of indexes taken at once by a thread
+     */
+    template <typename Functor>
+    Status iterateRange (u_int64_t begin, u_int64_t end, const Functor& functor, size_t groupSize = 1)
+    {
+        Status status;
+
+        if (groupSize == 0)  { groupSize = 1; }
+
+        /** We split the range in one shard per execution unit. */
+        size_t    nbUnits = getExecutionUnitsNumber();
+        u_int64_t nbItems = end > begin ? end - begin : 0;
+
+        std::vector<RangeShard> shards (nbUnits);
+        for (size_t i=0; i<nbUnits; i++)
+        {
+            shards[i].next = begin + (nbItems * i)     / nbUnits;
+            shards[i].end  = begin + (nbItems * (i+1)) / nbUnits;
+        }
+
+        /** We create N RangeCommand instances, each one starting on its own shard. */
+        std::vector<ICommand*> commands;
+        for (size_t i=0; i<nbUnits; i++)
+        {
+            commands.push_back (new RangeCommand<Functor> (shards, i, new Functor (functor), groupSize));
+        }
+
+        /** We dispatch the commands. */
+        status.time      = dispatchCommands (commands);
+        status.nbCores   = commands.size();
+        status.groupSize = groupSize;
+
+        return status;
+    }
+
+    /** Iterate the items of a vector without any shared lock (see iterateRange).
+     * \param[in] items : the vector to be iterated
+     * \param[in] functor : functor object to be cloned N times, one per thread; called with each item.
+     * \param[in] groupSize : number of items taken at once by a thread
+     */
+    template <typename Item, typename Functor>
+    Status iterate (std::vector<Item>& items, const Functor& functor, size_t groupSize = 1000)
+    {
+        return iterateRange (0, items.size(), VectorFunctor<Item,Functor> (items, functor), groupSize);
+    }
+
+    /** Iterate an iterator made of independent parts (see Iterator::getComposition), for instance the
+     * iterator over a partitioned collection. Each part is iterated as a whole by one thread and the
+     * parts are distributed among the threads as in iterateRange, so no shared lock is needed for getting
+     * the items. If the iterator has only one part, we fall back to the usual iterate method.
+     *
+     * The items are provided to the functors in the order of each part, but with no global order.
+     * If the iterator notifies some progress listeners, they are still notified, by groups of 'groupSize' items.
+     *
+     * \param[in] iterator : the iterator to be iterated
+     * \param[in] functor : functor object to be cloned N times, one per thread
+     * \param[in] groupSize : number of items notified at once to the progress listeners (if any)
+     */
+    template <typename Item, typename Functor>
+    Status iterateSplit (Iterator<Item>* iterator, const Functor& functor, size_t groupSize = 1000)
+    {
+        Status status;
+
+        iterator->use();
+
+        std::vector<Iterator<Item>*> parts = iterator->getComposition();
+
+        if (parts.size() <= 1)
+        {
+            /** Nothing to split => we use the iteration with a shared synchronizer. */
+            status = iterate (iterator, functor, groupSize);
+        }
+        else
+        {
+            for (size_t i=0; i<parts.size(); i++)  { parts[i]->use(); }
+
+            /** We may have to notify the progress listeners of the iterator. */
+            impl::AbstractSubjectIterator* subject = dynamic_cast<impl::AbstractSubjectIterator*> (iterator);
+            system::ISynchronizer* synchro = newSynchro();
+
+            if (subject != 0)  { subject->notifyInit(); }
+
+            status = iterateRange (0, parts.size(), SplitFunctor<Item,Functor> (parts, functor, subject, synchro, groupSize), 1);
+
+            if (subject != 0)  { subject->notifyFinish(); }
+
+            delete synchro;
+
+            for (size_t i=0; i<parts.size(); i++)  { parts[i]->forget(); }
+        }
+
+        iterator->forget();
+
+        return status;
+    }
+
     /** Set the number of items to be retrieved from the iterator by one thread in a synchronized way.
      * \param[in] groupSize : number of items to be retrieved. */
     virtual void   setGroupSize (size_t groupSize) = 0;
@@ -337,6 +448,115 @@ protected:
         size_t                 _groupSize;
         bool                   _deleteSynchro;
     };
+
+    /* Shard of a range of indexes, alone on its cache line since it is updated by atomic operations. */
+    struct RangeShard
+    {
+        RangeShard () : next(0), end(0)  {}
+        u_int64_t next;
+        u_int64_t end;
+        char      padding [64 - 2*sizeof(u_int64_t)];
+    };
+
+    /* We need some inner class for iterating some range of indexes in one thread. */
+    template <typename Functor> class RangeCommand : public ICommand, public system::SmartPointer
+    {
+    public:
+        /** Constructor.
+         * \param[in] shards : shards of the range (shared by several RangeCommand instances)
+         * \param[in] shardIdx : index of the shard of the current command
+         * \param[in] fct : functor called with the iterated indexes; deleted at the end of execute
+         * \param[in] groupSize : number of indexes got from a shard in one atomic operation.
+         */
+        RangeCommand (std::vector<RangeShard>& shards, size_t shardIdx, Functor* fct, size_t groupSize)
+            : _shards(shards), _shardIdx(shardIdx), _fct(fct), _groupSize(groupSize)  {}
+
+        /** Implementation of the ICommand interface.*/
+        void execute ()
+        {
+            u_int64_t begin, end;
+
+            while (grab (begin, end))
+            {
+                for (u_int64_t idx=begin; idx<end; idx++)  {  (*_fct) (idx);  }
+            }
+
+            /** We do not need the functor after that, delete it here to have parallel delete */
+            delete _fct;
+        }
+
+    private:
+
+        /** We take a group of indexes from our own shard first, then from the other shards (work stealing).
+         * \return false if all the shards are exhausted. */
+        bool grab (u_int64_t& begin, u_int64_t& end)
+        {
+            for (size_t i=0; i<_shards.size(); i++)
+            {
+                RangeShard& shard = _shards [(_shardIdx + i) % _shards.size()];
+
+                if (shard.next >= shard.end)  { continue; }
+
+                begin = __sync_fetch_and_add (&shard.next, _groupSize);
+
+                if (begin < shard.end)  {  end = std::min (begin + _groupSize, shard.end);  return true;  }
+            }
+            return false;
+        }
+
+        std::vector<RangeShard>& _shards;
+        size_t                   _shardIdx;
+        Functor*                 _fct;
+        size_t                   _groupSize;
+    };
+
+    /* Functor adapting an index to an item of a vector. */
+    template <typename Item, typename Functor> struct VectorFunctor
+    {
+        VectorFunctor (std::vector<Item>& items, const Functor& fct) : items(items), fct(fct)  {}
+        void operator() (u_int64_t idx)  {  fct (items[idx]);  }
+        std::vector<Item>& items;
+        Functor            fct;
+    };
+
+    /* Functor iterating the part of a composite iterator given by an index. */
+    template <typename Item, typename Functor> struct SplitFunctor
+    {
+        SplitFunctor (std::vector<Iterator<Item>*>& parts, const Functor& fct, impl::AbstractSubjectIterator* subject,
+            system::ISynchronizer* synchro, size_t groupSize)
+            : parts(parts), fct(fct), subject(subject), synchro(synchro), groupSize(groupSize)  {}
+
+        void operator() (u_int64_t idx)
+        {
+            Iterator<Item>* it = parts[idx];
+
+            /** Each thread uses its own item, in case the parts would share the item of the composite iterator. */
+            Item item;
+            it->setItem (item);
+
+            size_t nb = 0;
+            for (it->first(); !it->isDone(); it->next())
+            {
+                fct (it->item());
+                if (++nb == groupSize)  { notify (nb);  nb = 0; }
+            }
+            notify (nb);
+
+            it->finalize ();
+            it->reset ();
+        }
+
+        void notify (size_t nb)
+        {
+            if (subject != 0 && nb > 0)  {  system::LocalSynchronizer ls (synchro);  subject->notifyInc (nb);  }
+        }
+
+        std::vector<Iterator<Item>*>&  parts;
+        Functor                        fct;
+        impl::AbstractSubjectIterator* subject;
+        system::ISynchronizer*         synchro;
+        size_t                         groupSize;
+    };
 };
 
 /********************************************************************************/
@@ -327,8 +327,6 @@ public:
         }
     }
 
-protected:
-
     /** Notify all the subscribed functors.
      * \param[in] current : number of currently iterated items during the iteration. */
     void notifyInc (u_int64_t current)
@@ -1042,6 +1040,19 @@ public:
     /** */
     T2& item ()  { return Adaptor() (_ref->item()); }
 
+    /** Get a vector holding the composite structure of the iterator: each part of the referred
+     * iterator is adapted on its own (the created adaptors are owned by the caller). */
+    std::vector<Iterator<T2>*> getComposition()
+    {
+        std::vector<Iterator<T1>*> parts = _ref->getComposition();
+        std::vector<Iterator<T2>*> res;
+
+        if (parts.size() <= 1)  {  res.push_back (this);  return res;  }
+
+        for (size_t i=0; i<parts.size(); i++)  {  res.push_back (new IteratorAdaptor<T1,T2,Adaptor> (parts[i]));  }
+        return res;
+    }
+
 private:
 
     Iterator<T1>* _ref;
@@ -21,6 +21,9 @@
  *  \date 01/03/2013
  *  \author edrezen
  *  \brief Fast computation of lexicographical minimizers wtih no-AA-inside constraint
+ *
+ *  Also holds MinimizerWindow, a lookup-table free computation of the minimizer of a window
+ *  of mmers (lexicographic or frequency order), vectorized with AVX2 when the CPU has it.
  */
 
 
@@ -29,6 +32,12 @@
 
 
 #include <stdint.h>
+#include <stddef.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GATB_MINIMIZER_AVX2
+#include <immintrin.h>
+#endif
 
 extern const unsigned char revcomp_4NT[];
 
@@ -151,4 +160,239 @@ template<typename T, typename minimizer_type> inline void fastLexiMinimizerChunk
     } // end while (minimizers)
 }
 
+/********************************************************************************/
+
+/** \brief Minimizer of a window of mmers, without lookup table.
+ *
+ * The mmers of a kmer are given as 2-bit encoded integers (m <= 31), the first one of the
+ * array being the one in the lowest bits of the kmer. As with the lookup table of ModelMinimizer,
+ * each mmer is first normalized: it is replaced by its canonical form (if required), then by the
+ * default minimizer (the mmer of m 'G') if it holds AA inside (only in lexicographic order). The
+ * minimizer is the first normalized mmer whose key is strictly lower than the key of the default
+ * minimizer and of every previous mmer; the key is the mmer itself, or (frequency,mmer) in
+ * frequency order.
+ *
+ * The normalization only needs a few bit operations, so m is not limited by the 4^m entries of
+ * a table (frequency order still needs its 4^m frequencies). The window is processed 4 mmers
+ * at a time with AVX2 when the CPU supports it; the choice is done at runtime, so the library
+ * doesn't need to be built for AVX2.
+ */
+class MinimizerWindow
+{
+public:
+
+    /** Constructor.
+     * \param[in] m : size of the mmers (<= 31)
+     * \param[in] canonical : true if a mmer has to be replaced by min(mmer,revcomp(mmer))
+     * \param[in] checkAllowed : true if mmers with AA inside are forbidden
+     * \param[in] freq : 4^m table of frequencies for the frequency order, 0 for the lexicographic one. */
+    MinimizerWindow (unsigned int m=1, bool canonical=true, bool checkAllowed=true, const uint32_t* freq=0)
+        : _m(m), _canonical(canonical), _checkAllowed(checkAllowed), _freq(freq)
+    {
+        _mask      = ((uint64_t)1 << (2*m)) - 1;
+        _allowed   = m >= 2 ? 0x5555555555555555ULL & (((uint64_t)1 << (2*(m-2))) - 1) : 0;
+        _default   = _mask;
+        _useAVX2   = hasAVX2() && (_freq==0 || m <= 16);
+    }
+
+    /** Set the frequencies of the mmers.
+     * \param[in] freq : 4^m table of frequencies, 0 for the lexicographic order. */
+    void setFrequencies (const uint32_t* freq)  {  _freq = freq;  _useAVX2 = hasAVX2() && (_freq==0 || _m <= 16);  }
+
+    /** Get the default minimizer, ie. the minimizer of a window without allowed mmer. */
+    uint64_t getDefault () const  { return _default; }
+
+    /** Normalize a mmer: canonical form and forbidden mmers (see class documentation).
+     * \param[in] mmer : the mmer
+     * \return the normalized mmer. */
+    uint64_t normalize (uint64_t mmer) const
+    {
+        if (_canonical)
+        {
+            uint64_t rev = revcomp (mmer);
+            if (rev < mmer)  { mmer = rev; }
+        }
+        if (_checkAllowed)
+        {
+            /** No AA inside the mmer, except at its beginning (KMC2 heuristic). */
+            uint64_t a1 = ~(mmer | (mmer >> 2));
+            if (((a1 >> 1) & a1 & _allowed) != 0)  { mmer = _default; }
+        }
+        return mmer;
+    }
+
+    /** Tells whether a normalized mmer is strictly lower than another one.
+     * \param[in] a : first normalized mmer
+     * \param[in] b : second normalized mmer
+     * \return true if a < b according to the order of the window. */
+    bool less (uint64_t a, uint64_t b) const
+    {
+        if (_freq != 0 && _freq[a] != _freq[b])  {  return _freq[a] < _freq[b];  }
+        return a < b;
+    }
+
+    /** Extract the mmers of a kmer.
+     * \param[in] words : the kmer as 64 bits words, lowest word first
+     * \param[in] nb : number of mmers to extract
+     * \param[out] mmers : array of nb mmers, the first one in the lowest bits of the kmer. */
+    void extract (const uint64_t* words, size_t nb, uint64_t* mmers) const
+    {
+        for (size_t t=0; t<nb; t++)
+        {
+            size_t   w = (2*t) >> 6;
+            size_t   s = (2*t) & 63;
+            uint64_t x = words[w] >> s;
+            if (s + 2*_m > 64)  {  x |= words[w+1] << (64-s);  }
+            mmers[t] = x & _mask;
+        }
+    }
+
+    /** Compute the minimizer of a window of mmers.
+     * \param[in] mmers : the mmers (not normalized)
+     * \param[in] nb : number of mmers
+     * \param[out] minimizer : the normalized minimizer, or the default minimizer
+     * \return the index of the minimizer in the array, -1 if no mmer is lower than the default minimizer. */
+    int compute (const uint64_t* mmers, size_t nb, uint64_t& minimizer) const
+    {
+#ifdef GATB_MINIMIZER_AVX2
+        if (_useAVX2)  {  return computeAVX2 (mmers, nb, minimizer);  }
+#endif
+        return computeScalar (mmers, nb, minimizer);
+    }
+
+    /** Scalar version of compute. */
+    int computeScalar (const uint64_t* mmers, size_t nb, uint64_t& minimizer) const
+    {
+        return computeTail (mmers, 0, nb, -1, _default, minimizer);
+    }
+
+#ifdef GATB_MINIMIZER_AVX2
+    /** AVX2 version of compute (the CPU must support AVX2, see hasAVX2). Each lane keeps the
+     * first minimum of its mmers; the lanes are then merged, ties going to the lowest index. */
+    __attribute__((target("avx2"))) int computeAVX2 (const uint64_t* mmers, size_t nb, uint64_t& minimizer) const
+    {
+        const __m256i sign    = _mm256_set1_epi64x ((long long) 0x8000000000000000ULL);
+        const __m256i ones    = _mm256_set1_epi64x (-1);
+        const __m256i comp    = _mm256_set1_epi64x ((long long) 0xAAAAAAAAAAAAAAAAULL);
+        const __m256i m0F     = _mm256_set1_epi64x ((long long) 0x0F0F0F0F0F0F0F0FULL);
+        const __m256i m33     = _mm256_set1_epi64x ((long long) 0x3333333333333333ULL);
+        const __m256i bswap   = _mm256_setr_epi8 (7,6,5,4,3,2,1,0, 15,14,13,12,11,10,9,8, 7,6,5,4,3,2,1,0, 15,14,13,12,11,10,9,8);
+        const __m128i shift   = _mm_cvtsi32_si128 (64 - 2*_m);
+        const __m256i allowed = _mm256_set1_epi64x ((long long) _allowed);
+        const __m256i def     = _mm256_set1_epi64x ((long long) _default);
+        const __m256i four    = _mm256_set1_epi64x (4);
+
+        __m256i bestKey = _mm256_xor_si256 (_mm256_set1_epi64x ((long long) key(_default)), sign);
+        __m256i bestIdx = ones;
+        __m256i idx     = _mm256_setr_epi64x (0, 1, 2, 3);
+
+        size_t t = 0;
+        for ( ; t+4 <= nb; t += 4)
+        {
+            __m256i c = _mm256_loadu_si256 ((const __m256i*) (mmers+t));
+
+            if (_canonical)
+            {
+                /** We reverse the nucleotides (bytes, then nibbles, then pairs of bits) and complement them;
+                 * mmers hold at most 62 bits, so the signed comparison gives the min. */
+                __m256i r = _mm256_shuffle_epi8 (c, bswap);
+                r = _mm256_or_si256 (_mm256_and_si256 (_mm256_srli_epi64 (r, 4), m0F), _mm256_slli_epi64 (_mm256_and_si256 (r, m0F), 4));
+                r = _mm256_or_si256 (_mm256_and_si256 (_mm256_srli_epi64 (r, 2), m33), _mm256_slli_epi64 (_mm256_and_si256 (r, m33), 2));
+                r = _mm256_srl_epi64 (_mm256_xor_si256 (r, comp), shift);
+                c = _mm256_blendv_epi8 (c, r, _mm256_cmpgt_epi64 (c, r));
+            }
+
+            if (_checkAllowed)
+            {
+                __m256i a1 = _mm256_xor_si256 (_mm256_or_si256 (c, _mm256_srli_epi64 (c, 2)), ones);
+                a1 = _mm256_and_si256 (_mm256_and_si256 (_mm256_srli_epi64 (a1, 1), a1), allowed);
+                c  = _mm256_blendv_epi8 (def, c, _mm256_cmpeq_epi64 (a1, _mm256_setzero_si256()));
+            }
+
+            __m256i k = c;
+            if (_freq != 0)
+            {
+                __m128i f = _mm256_i64gather_epi32 ((const int*) _freq, c, 4);
+                k = _mm256_or_si256 (_mm256_slli_epi64 (_mm256_cvtepu32_epi64 (f), 32), c);
+            }
+
+            /** Unsigned comparison of the keys through the sign bit. */
+            k = _mm256_xor_si256 (k, sign);
+            __m256i lower = _mm256_cmpgt_epi64 (bestKey, k);
+            bestKey = _mm256_blendv_epi8 (bestKey, k,   lower);
+            bestIdx = _mm256_blendv_epi8 (bestIdx, idx, lower);
+            idx     = _mm256_add_epi64 (idx, four);
+        }
+
+        uint64_t keys[4];  int64_t idxs[4];
+        _mm256_storeu_si256 ((__m256i*) keys, _mm256_xor_si256 (bestKey, sign));
+        _mm256_storeu_si256 ((__m256i*) idxs, bestIdx);
+
+        int64_t best = -1;
+        for (size_t l=0; l<4; l++)
+        {
+            if (idxs[l] < 0)  { continue; }
+            if (best < 0 || keys[l] < keys[best] || (keys[l] == keys[best] && idxs[l] < idxs[best]))  {  best = l;  }
+        }
+
+        int      bestPos   = best < 0 ? -1       : (int) idxs[best];
+        uint64_t bestValue = best < 0 ? _default : normalize (mmers[bestPos]);
+
+        return computeTail (mmers, t, nb, bestPos, bestValue, minimizer);
+    }
+#endif
+
+    /** Tells whether the CPU supports AVX2. */
+    static bool hasAVX2 ()
+    {
+#ifdef GATB_MINIMIZER_AVX2
+        static const bool result = checkAVX2();
+        return result;
+#else
+        return false;
+#endif
+    }
+
+private:
+
+    unsigned int    _m;
+    bool            _canonical;
+    bool            _checkAllowed;
+    const uint32_t* _freq;
+    uint64_t        _mask;
+    uint64_t        _allowed;
+    uint64_t        _default;
+    bool            _useAVX2;
+
+    uint64_t revcomp (uint64_t x) const
+    {
+        x = ((x>> 2 & 0x3333333333333333ULL) | (x & 0x3333333333333333ULL) <<  2);
+        x = ((x>> 4 & 0x0F0F0F0F0F0F0F0FULL) | (x & 0x0F0F0F0F0F0F0F0FULL) <<  4);
+        x = __builtin_bswap64 (x) ^ 0xAAAAAAAAAAAAAAAAULL;
+        return x >> (64 - 2*_m);
+    }
+
+    /** Key of a normalized mmer, as used by the AVX2 version (frequency only for m <= 16). */
+    uint64_t key (uint64_t mmer) const  {  return _freq != 0 ? ((uint64_t)_freq[mmer] << 32) | mmer : mmer;  }
+
+    int computeTail (const uint64_t* mmers, size_t from, size_t nb, int bestPos, uint64_t bestValue, uint64_t& minimizer) const
+    {
+        for (size_t t=from; t<nb; t++)
+        {
+            uint64_t candidate = normalize (mmers[t]);
+            if (less (candidate, bestValue))  {  bestValue = candidate;  bestPos = t;  }
+        }
+        minimizer = bestValue;
+        return bestPos;
+    }
+
+#ifdef GATB_MINIMIZER_AVX2
+    static bool checkAVX2 ()
+    {
+        __builtin_cpu_init ();
+        return __builtin_cpu_supports ("avx2");
+    }
+#endif
+};
+
 #endif
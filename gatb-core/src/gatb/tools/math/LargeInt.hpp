@@ -388,6 +388,7 @@ public:
     LargeInt operator<<(const int& coeff) const
     {
         LargeInt result;
+
         result.setVal(0);
 
         int large_shift = coeff / 64;
@@ -423,6 +424,7 @@ public:
     LargeInt operator>>(const int& coeff) const
     {
         LargeInt result;
+
         result.setVal(0);
 
         int large_shift = coeff / 64;
@@ -455,10 +457,7 @@ public:
      */
     bool operator!=(const LargeInt& c) const
     {
-        for (int i = 0 ; i < precision ; i++)
-            if( this->value[i] != c.value[i] )
-                return true;
-        return false;
+        return ! operator==(c);
     }
 
     bool operator!=(const u_int64_t& c) const
@@ -478,10 +477,9 @@ public:
      */
     bool operator==(const LargeInt& c) const
     {
-        for (int i = 0 ; i < precision ; i++)
-            if( this->value[i] != c.value[i] )
-                return false;
-        return true;
+        u_int64_t diff = 0;
+        for (int i = 0 ; i < precision ; i++)  {  diff |= this->value[i] ^ c.value[i];  }
+        return diff == 0;
     }
 
     bool operator==(const u_int64_t& c) const
@@ -501,6 +499,8 @@ public:
      */
     bool operator<(const LargeInt& c) const
     {
+        /** Note: a branch-free version (borrow of the subtraction) is slower, since the highest
+         * words of kmers almost always differ and the branch is well predicted. */
         for (int i = precision-1 ; i>=0 ; --i)
             if( this->value[i] != c.value[i] )
                 return this->value[i] < c.value[i];
@@ -514,7 +514,7 @@ public:
      */
     bool operator<=(const LargeInt& c) const
     {
-        return operator==(c) || operator<(c);
+        return ! c.operator<(*this);
     }
 
     /********************************************************************************/
@@ -699,6 +699,11 @@ public:
     u_int8_t  operator[]  (size_t idx) const    {  
         return (this->value[idx/32] >> (2*(idx % 32))) & 3; }
 
+    /** Get the ith byte of the integer (0 being the less significant byte).
+     * \param[in] idx : index of the byte to be retrieved
+     * \return the byte value */
+    u_int8_t  getByte (size_t idx) const  {  return (this->value[idx/8] >> (8*(idx % 8))) & 0xFF; }
+
 private:
     u_int64_t value[precision];
    
@@ -721,14 +726,11 @@ private:
 /********************************************************************************/
 template<int precision>  inline LargeInt<precision> revcomp (const LargeInt<precision>& x, size_t sizeKmer)
 {
+    /** We reverse each word (without table) and reverse the order of the words. */
     LargeInt<precision> res;
-    res.setVal(0);
-    unsigned char* kmerrev  = (unsigned char *) (&(res.value[0]));
-    unsigned char* kmer     = (unsigned char *) (&(x.value[0]));
-
-    for (size_t i=0; i<8*precision; ++i)
+    for (int i=0; i<precision; ++i)
     {
-        kmerrev[8*precision-1-i] = revcomp_4NT [kmer[i]];
+        res.value[precision-1-i] = NativeInt64::revcompWord (x.value[i]);
     }
 
     return (res >> (2*( 32*precision - sizeKmer))  ) ;
@@ -774,14 +776,11 @@ template<int precision>  inline u_int64_t hash2 (const LargeInt<precision>& elem
 template<int precision>  u_int64_t oahash (const LargeInt<precision>& elem)
 {
     // hash = XOR_of_series[hash(i-th chunk iof 64 bits)]
-    u_int64_t result = 0, chunk, mask = ~0;
+    u_int64_t result = 0;
 
-    LargeInt<precision> intermediate = elem;
     for (size_t i=0;i<precision;i++)
     {
-        chunk = (intermediate & mask).value[0];
-        intermediate = intermediate >> 64;
-        result ^= NativeInt64::oahash64 (chunk);
+        result ^= NativeInt64::oahash64 (elem.value[i]);
     }
     return result;
 }
@@ -791,13 +790,7 @@ template<int precision>  u_int64_t oahash (const LargeInt<precision>& elem)
 /********************************************************************************/
 template<int precision> inline u_int64_t simplehash16 (const LargeInt<precision>& elem, int  shift)
 {
-    u_int64_t result = 0, chunk, mask = ~0;
-    LargeInt<precision> intermediate = elem;
-    
-    chunk = (intermediate & mask).value[0];
-    result ^= NativeInt64::simplehash16_64 (chunk,shift);
-
-    return result;
+    return NativeInt64::simplehash16_64 (elem.value[0], shift);
 }
 
 /*
@@ -84,6 +84,8 @@ public:
 
     u_int8_t  operator[]  (size_t idx) const   {  return (value >> (2*idx)) & 3; }
 
+    u_int8_t  getByte (size_t idx) const  {  return (value >> (8*idx)) & 0xFF; }
+
     /********************************************************************************/
     friend std::ostream & operator<<(std::ostream & s, const LargeInt<1> & l)
     {
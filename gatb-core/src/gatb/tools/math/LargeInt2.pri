@@ -78,6 +78,8 @@ public:
 
     u_int8_t  operator[]  (size_t idx) const   {  return (value >> (2*idx)) & 3; }
 
+    u_int8_t  getByte (size_t idx) const  {  return (value >> (8*idx)) & 0xFF; }
+
     /** Output stream overload. NOTE: for easier process, dump the value in hexadecimal.
      * \param[in] os : the output stream
      * \param[in] in : the integer value to be output.
@@ -174,25 +176,15 @@ inline LargeInt<2> revcomp (const LargeInt<2>& in, size_t sizeKmer)
     //
     //revcomp:        [         CA  | .......GT   ]
     //                 \_low_nucl__/\high_nucl/
+    //
+    // we reverse each word, swap them and shift the whole to the kmer size.
 
     const __uint128_t& x = in.value;
 
-    u_int64_t high_nucl = (u_int64_t)(x>>64);
-    int nb_high_nucl = sizeKmer>32?sizeKmer - 32:0;
-
-    u_int64_t revcomp_high_nucl = NativeInt64::revcomp64 (high_nucl, nb_high_nucl);
-
-    if (sizeKmer<=32) revcomp_high_nucl = 0; // srsly dunno why this is needed. gcc bug? u_int64_t x ---> (x>>64) != 0
-
-    u_int64_t low_nucl = (u_int64_t)(x&((((__uint128_t)1)<<64)-1));
-    int nb_low_nucl = sizeKmer>32?32:sizeKmer;
-
-    u_int64_t revcomp_low_nucl = NativeInt64::revcomp64 (low_nucl, nb_low_nucl);
+    __uint128_t rev = ((__uint128_t) NativeInt64::revcompWord ((u_int64_t) x) << 64) | NativeInt64::revcompWord ((u_int64_t) (x >> 64));
 
     LargeInt<2> res;
-    res.setVal(revcomp_low_nucl);
-    res <<= 2* nb_high_nucl;
-    res += revcomp_high_nucl;
+    res.value = rev >> (2*(64 - sizeKmer));
     return res;
 }
 
@@ -145,14 +145,17 @@ public:
     /********************************************************************************/
     inline static u_int64_t revcomp64 (const u_int64_t& x, size_t sizeKmer)
     {
-        u_int64_t res = x;
-
-        unsigned char* kmerrev  = (unsigned char *) (&(res));
-        unsigned char* kmer     = (unsigned char *) (&(x));
-
-        for (size_t i=0; i<8; ++i)  {  kmerrev[8-1-i] = revcomp_4NT [kmer[i]];  }
+        return (revcompWord (x) >> (2*( 32 - sizeKmer))) ;
+    }
 
-        return (res >> (2*( 32 - sizeKmer))) ;
+    /********************************************************************************/
+    /** Reverse complement of the 32 nucleotides of a word, without table: the pairs of bits
+     * are reversed (pairs, nibbles then bytes) and complemented (A<->T and C<->G by xor 2). */
+    inline static u_int64_t revcompWord (u_int64_t x)
+    {
+        x = ((x>> 2 & 0x3333333333333333ULL) | (x & 0x3333333333333333ULL) <<  2);
+        x = ((x>> 4 & 0x0F0F0F0F0F0F0F0FULL) | (x & 0x0F0F0F0F0F0F0F0FULL) <<  4);
+        return __builtin_bswap64 (x) ^ 0xAAAAAAAAAAAAAAAAULL;
     }
 
 	
@@ -36,6 +36,10 @@
 #include <iostream>
 #include <string.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 /********************************************************************************/
 namespace gatb      {
 namespace core      {
@@ -176,9 +180,62 @@ public:
      * and was equal to 0 for 'N' and 'n' 
      * but unfortunately it doesn't work for some of the IUPAC codes, like 'R' 
      * */
-    struct ConvertASCII    { static ConvertChar get (const char* buffer, size_t idx)  { return ConvertChar((buffer[idx]>>1) & 3, validNucleotide[(unsigned char)(buffer[idx])]); }};
-    struct ConvertInteger  { static ConvertChar get (const char* buffer, size_t idx)  { return ConvertChar(buffer[idx],0); }         };
-    struct ConvertBinary   { static ConvertChar get (const char* buffer, size_t idx)  { return ConvertChar(((buffer[idx>>2] >> ((3-(idx&3))*2)) & 3),0); } };
+    /** Each conversion class also converts a chunk of (at most 64) nucleotides at once with getChunk:
+     *  the nucleotide values are written in 'codes' and the invalid nucleotides are returned as a
+     *  bitmap (bit i for the nucleotide idx+i). */
+    struct ConvertASCII
+    {
+        static ConvertChar get (const char* buffer, size_t idx)  { return ConvertChar((buffer[idx]>>1) & 3, validNucleotide[(unsigned char)(buffer[idx])]); }
+
+        static u_int64_t getChunk (const char* buffer, size_t idx, size_t nb, char* codes)
+        {
+            u_int64_t invalid = 0;
+            size_t    i       = 0;
+#ifdef __SSE2__
+            /** 16 characters at a time: the value is in the bits 1-2 of the character, and only
+             * A,C,G,T (in any case) are valid, ie. the characters equal to a,c,g,t once in lower case. */
+            const __m128i three = _mm_set1_epi8 (3);
+            const __m128i lower = _mm_set1_epi8 (0x20);
+            for ( ; i+16 <= nb; i += 16)
+            {
+                __m128i v = _mm_loadu_si128 ((const __m128i*) (buffer + idx + i));
+                _mm_storeu_si128 ((__m128i*) (codes + i), _mm_and_si128 (_mm_srli_epi16 (v, 1), three));
+
+                __m128i l     = _mm_or_si128 (v, lower);
+                __m128i valid = _mm_or_si128 (
+                    _mm_or_si128 (_mm_cmpeq_epi8 (l, _mm_set1_epi8 ('a')), _mm_cmpeq_epi8 (l, _mm_set1_epi8 ('c'))),
+                    _mm_or_si128 (_mm_cmpeq_epi8 (l, _mm_set1_epi8 ('g')), _mm_cmpeq_epi8 (l, _mm_set1_epi8 ('t')))
+                );
+                invalid |= (u_int64_t) (~_mm_movemask_epi8 (valid) & 0xFFFF) << i;
+            }
+#endif
+            for ( ; i<nb; i++)
+            {
+                ConvertChar c = get (buffer, idx+i);
+                codes[i] = c.first;
+                invalid |= (u_int64_t) c.second << i;
+            }
+            return invalid;
+        }
+    };
+
+    struct ConvertInteger
+    {
+        static ConvertChar get (const char* buffer, size_t idx)  { return ConvertChar(buffer[idx],0); }
+
+        static u_int64_t getChunk (const char* buffer, size_t idx, size_t nb, char* codes)  {  memcpy (codes, buffer+idx, nb);  return 0;  }
+    };
+
+    struct ConvertBinary
+    {
+        static ConvertChar get (const char* buffer, size_t idx)  { return ConvertChar(((buffer[idx>>2] >> ((3-(idx&3))*2)) & 3),0); }
+
+        static u_int64_t getChunk (const char* buffer, size_t idx, size_t nb, char* codes)
+        {
+            for (size_t i=0; i<nb; i++)  {  codes[i] = get (buffer, idx+i).first;  }
+            return 0;
+        }
+    };
 
     static const unsigned char validNucleotide[];
 private:
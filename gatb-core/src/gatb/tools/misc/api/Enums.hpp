@@ -77,6 +77,8 @@ enum BloomKind
     BLOOM_CACHE,
     /** Implementation of Bloom filters improving CPU cache management. */
     BLOOM_NEIGHBOR,
+    /** Implementation of Bloom filters with all the bits of an item in one CPU cache line. */
+    BLOOM_BLOCKED,
     BLOOM_DEFAULT
 };
 
@@ -89,6 +91,7 @@ static void parse (const std::string& s, BloomKind& kind)
     else if (s == "basic")       { kind = BLOOM_BASIC;  }
     else if (s == "cache")       { kind = BLOOM_CACHE; }
 	else if (s == "neighbor")    { kind = BLOOM_NEIGHBOR; }
+    else if (s == "blocked")     { kind = BLOOM_BLOCKED; }
     else if (s == "default")     { kind = BLOOM_CACHE; }
     else   { throw system::Exception ("bad Bloom kind '%s'", s.c_str()); }
 }
@@ -104,6 +107,7 @@ static const char* toString (BloomKind kind)
         case BLOOM_BASIC:     return "basic";
         case BLOOM_CACHE:     return "cache";
 		case BLOOM_NEIGHBOR:  return "neighbor";
+        case BLOOM_BLOCKED:   return "blocked";
         case BLOOM_DEFAULT:   return "cache";
         default:        throw system::Exception ("bad Bloom kind %d", kind);
     }
@@ -120,6 +124,8 @@ enum DebloomKind
     DEBLOOM_ORIGINAL,
     /** Save cFP with cascading Bloom filters. */
     DEBLOOM_CASCADING,
+    /** No Bloom filter nor cFP: the solid kmers are stored in a counting quotient filter. */
+    DEBLOOM_QUOTIENT,
     DEBLOOM_DEFAULT
 };
 
@@ -131,6 +137,7 @@ static void parse (const std::string& s, DebloomKind& kind)
          if (s == "none")       { kind = DEBLOOM_NONE;      }
     else if (s == "original")   { kind = DEBLOOM_ORIGINAL;  }
     else if (s == "cascading")  { kind = DEBLOOM_CASCADING; }
+    else if (s == "quotient")   { kind = DEBLOOM_QUOTIENT;  }
     else if (s == "default")    { kind = DEBLOOM_CASCADING; }
     else   { throw system::Exception ("bad debloom kind '%s'", s.c_str()); }
 }
@@ -145,6 +152,7 @@ static std::string toString (DebloomKind kind)
         case DEBLOOM_NONE:      return "none";
         case DEBLOOM_ORIGINAL:  return "original";
         case DEBLOOM_CASCADING: return "cascading";
+        case DEBLOOM_QUOTIENT:  return "quotient";
         case DEBLOOM_DEFAULT:   return "cascading";
         default:        throw system::Exception ("bad debloom kind %d", kind);
     }
@@ -275,6 +283,40 @@ static std::string toString (KmerSolidityKind kind)
 
 /********************************************************************************/
 
+/** Enumeration for the different ways of sorting the kmers of a partition during counting. */
+enum PartitionSortKind
+{
+    /** comparison sort (std::sort) */
+    PARTITION_SORT_STD,
+    /** in-place radix sort */
+    PARTITION_SORT_RADIX
+};
+
+/** Get the enum from a string.
+ * \param[in] s : string to be parsed
+ * \param[out] kind : enum to be set from the string parsing. */
+static void parse (const std::string& s, PartitionSortKind& kind)
+{
+         if (s == "std")     { kind = PARTITION_SORT_STD;    }
+    else if (s == "radix")   { kind = PARTITION_SORT_RADIX;  }
+    else   { throw system::Exception ("bad partition sort kind '%s'", s.c_str()); }
+}
+
+/** Get the string associated to an enum
+ * \param[in] kind : the enum value
+ * \return the associated string */
+static std::string toString (PartitionSortKind kind)
+{
+    switch (kind)
+    {
+        case PARTITION_SORT_STD:     return "std";
+        case PARTITION_SORT_RADIX:   return "radix";
+        default:        throw system::Exception ("bad partition sort kind %d", kind);
+    }
+}
+
+/********************************************************************************/
+
 /** Enumeration of different kinds of graph traversal. */
 enum TraversalKind
 {
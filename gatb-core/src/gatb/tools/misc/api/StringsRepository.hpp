@@ -122,6 +122,13 @@ public:
     const char* compress_level()   { return "-out-compress"; }
     const char* config_only()      { return "-config-only"; }
     const char* storage_type()     { return "-storage-type"; }
+    const char* parser_threads()   { return "-parser-threads"; }
+    const char* binary_mmap()      { return "-binary-mmap"; }
+    const char* partition_sort()   { return "-partition-sort"; }
+    const char* pipeline_passes()  { return "-pipeline-passes"; }
+    const char* disk_partitions()  { return "-disk-partitions"; }
+    const char* compress_partitions()  { return "-compress-partitions"; }
+    const char* async_writes()     { return "-async-writes"; }
 
     const char* attr_uri_input      ()  { return "input";           }
     const char* attr_kmer_size      ()  { return "kmer_size";       }
@@ -177,6 +184,13 @@ public:
 #define STR_COMPRESS_LEVEL      gatb::core::tools::misc::StringRepository::singleton().compress_level()
 #define STR_CONFIG_ONLY         gatb::core::tools::misc::StringRepository::singleton().config_only()
 #define STR_STORAGE_TYPE        gatb::core::tools::misc::StringRepository::singleton().storage_type ()
+#define STR_PARSER_THREADS      gatb::core::tools::misc::StringRepository::singleton().parser_threads ()
+#define STR_BINARY_MMAP         gatb::core::tools::misc::StringRepository::singleton().binary_mmap ()
+#define STR_PARTITION_SORT      gatb::core::tools::misc::StringRepository::singleton().partition_sort ()
+#define STR_PIPELINE_PASSES     gatb::core::tools::misc::StringRepository::singleton().pipeline_passes ()
+#define STR_DISK_PARTITIONS     gatb::core::tools::misc::StringRepository::singleton().disk_partitions ()
+#define STR_COMPRESS_PARTITIONS gatb::core::tools::misc::StringRepository::singleton().compress_partitions ()
+#define STR_ASYNC_WRITES        gatb::core::tools::misc::StringRepository::singleton().async_writes ()
 
 /********************************************************************************/
 
@@ -83,7 +83,11 @@ struct PropertiesParserVisitor : public HierarchyParserVisitor
 {
     IProperties* _props;
     PropertiesParserVisitor (IProperties* props) : _props(props) {}
-    void visitOption (Option& object, size_t depth)  {  _props->add (0, object.getName(), object.getDefaultValue());  }
+    void visitOption (Option& object, size_t depth)
+    {
+        /** Like for a parsed command line, a flag is set only when given, not by default. */
+        if (object.getNbArgs() > 0)  {  _props->add (0, object.getName(), object.getDefaultValue());  }
+    }
 };
 
 /*********************************************************************
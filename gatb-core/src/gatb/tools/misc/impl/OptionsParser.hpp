@@ -210,6 +210,7 @@ protected:
     std::string     _defaultParam;
 
     friend struct ParserVisitor;
+    friend struct PropertiesParserVisitor;
     friend class OptionsHelpVisitor;
 };
 
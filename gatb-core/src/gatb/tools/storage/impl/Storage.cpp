@@ -21,6 +21,13 @@
 
 #include <gatb/tools/storage/impl/Storage.hpp>
 
+#include <zlib.h>
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+
 /********************************************************************************/
 namespace gatb { namespace core {  namespace tools {  namespace storage {  namespace impl {
 /********************************************************************************/
@@ -306,19 +313,136 @@ Storage::istream::~istream ()
 ///////////////////////////////////////
 ////////// SuperKmerBinFiles //////////
 ///////////////////////////////////////
-	
-SuperKmerBinFiles::SuperKmerBinFiles(const std::string& path,const std::string& name, size_t nb_files) : _basefilename(name), _path(path),_nb_files(nb_files)
+
+//writer thread of the async mode : the blocks (with their header) are copied into recycled buffers
+//and queued ; the thread writes them in order, and is the only one to write into the files
+struct SuperKmerBinFiles::AsyncWriter
+{
+	//max size of the queued blocks ; beyond that, writeBlock waits for the writer
+	static const u_int64_t MAX_PENDING_BYTES = 64*1024*1024;
+
+	struct block_t
+	{
+		int file_id;
+		std::vector<u_int8_t> data;
+	};
+
+	AsyncWriter (SuperKmerBinFiles& ref) : ref(ref), pending(0), stop(false)
+	{
+		thread = std::thread ([this] ()  {  run();  });
+	}
+
+	~AsyncWriter ()
+	{
+		{
+			std::unique_lock<std::mutex> lock (mutex);
+			stop = true;
+		}
+		cond.notify_all();
+		thread.join();
+
+		for(size_t ii=0; ii<freeBlocks.size(); ii++)  {  delete freeBlocks[ii];  }
+	}
+
+	void post (unsigned char * block, unsigned int block_size, int file_id)
+	{
+		block_t* b = 0;
+		{
+			std::unique_lock<std::mutex> lock (mutex);
+			cond.wait (lock, [this] ()  {  return pending < MAX_PENDING_BYTES;  });
+			pending += sizeof(block_size) + block_size;
+			if(freeBlocks.empty())  {  b = new block_t;  }
+			else                    {  b = freeBlocks.back();  freeBlocks.pop_back();  }
+		}
+
+		//the copy is done out of the lock, so that the filling threads post in parallel
+		b->file_id = file_id;
+		b->data.resize (sizeof(block_size) + block_size);
+		memcpy (b->data.data(), &block_size, sizeof(block_size));
+		memcpy (b->data.data() + sizeof(block_size), block, block_size);
+
+		{
+			std::unique_lock<std::mutex> lock (mutex);
+			todo.push_back (b);
+		}
+		cond.notify_all();
+	}
+
+	void wait ()
+	{
+		std::unique_lock<std::mutex> lock (mutex);
+		cond.wait (lock, [this] ()  {  return pending == 0;  });
+	}
+
+	void run ()
+	{
+		std::unique_lock<std::mutex> lock (mutex);
+		while (true)
+		{
+			cond.wait (lock, [this] ()  {  return !todo.empty() || stop;  });
+			if (todo.empty())  {  break;  }
+
+			block_t* b = todo.front();
+			todo.pop_front();
+
+			lock.unlock();
+			ref._files[b->file_id]->fwrite (b->data.data(), sizeof(u_int8_t), b->data.size());
+			lock.lock();
+
+			pending -= b->data.size();
+			freeBlocks.push_back (b);
+			cond.notify_all();
+		}
+	}
+
+	SuperKmerBinFiles&      ref;
+	std::mutex              mutex;
+	std::condition_variable cond;
+	std::thread             thread;
+	std::deque<block_t*>    todo;
+	std::vector<block_t*>   freeBlocks;
+	u_int64_t               pending;
+	bool                    stop;
+};
+
+SuperKmerBinFiles::SuperKmerBinFiles(const std::string& path,const std::string& name, size_t nb_files, bool inMemory, bool compressed, bool asyncWrites) : _basefilename(name), _path(path),_nb_files(nb_files), _inMemory(inMemory), _compressed(compressed), _writer(0)
 {
 	_nbKmerperFile.resize(_nb_files,0);
 	_FileSize.resize(_nb_files,0);
 	
+	if(_inMemory)
+	{
+		//no file at all : the synchros live as long as the buffers
+		_files.resize(_nb_files,0);
+		_memFiles.resize(_nb_files);
+		_memReadPos.resize(_nb_files,0);
+		for(int ii=0;ii<_nb_files;ii++)
+		{
+			_synchros.push_back (system::impl::System::thread().newSynchronizer());
+			_synchros[ii]->use();
+		}
+		return;
+	}
+
 	openFiles("wb"); //at construction will open file for writing
 	// then use close() and openFiles() to open for reading
 	
+	if(asyncWrites)  {  _writer = new AsyncWriter(*this);  }
+}
+
+void SuperKmerBinFiles::waitWrites()
+{
+	if(_writer!=0)  {  _writer->wait();  }
 }
 
 void SuperKmerBinFiles::openFile( const char* mode, int fileId)
 {
+	if(_inMemory)
+	{
+		_memReadPos[fileId] = 0;
+		return;
+	}
+
 	std::stringstream ss;
 	ss << _basefilename << "." << fileId;
 		
@@ -329,6 +453,12 @@ void SuperKmerBinFiles::openFile( const char* mode, int fileId)
 	
 void SuperKmerBinFiles::openFiles( const char* mode)
 {
+	if(_inMemory)
+	{
+		for(int ii=0;ii<_nb_files;ii++)  {  _memReadPos[ii] = 0;  }
+		return;
+	}
+
 	_files.resize(_nb_files,0);
 	_synchros.resize(_nb_files,0);
 	
@@ -349,6 +479,8 @@ void SuperKmerBinFiles::openFiles( const char* mode)
 	
 std::string SuperKmerBinFiles::getFileName(int fileId)
 {
+	//in memory mode, the directory is only created if some file is derived from this name
+	if(_inMemory)  {  system::impl::System::file().mkdir(_path, 0755);  }
 	
 	std::stringstream ss;
 	ss << _path << "/" <<_basefilename << "." << fileId;
@@ -357,31 +489,71 @@ std::string SuperKmerBinFiles::getFileName(int fileId)
 }
 
 	
+int SuperKmerBinFiles::readData(void* data, unsigned int nb_bytes, int file_id)
+{
+	if(_inMemory)
+	{
+		std::vector<u_int8_t>& mem = _memFiles[file_id];
+		u_int64_t& pos = _memReadPos[file_id];
+
+		if(pos + nb_bytes > mem.size())  {  return 0;  }
+
+		memcpy(data, mem.data() + pos, nb_bytes);
+		pos += nb_bytes;
+		return nb_bytes;
+	}
+
+	return _files[file_id]->fread(data, nb_bytes, 1) * nb_bytes;
+}
+
 int SuperKmerBinFiles::readBlock(unsigned char ** block, unsigned int* max_block_size, unsigned int* nb_bytes_read, int file_id)
 {
+	unsigned int stored_size = 0;
+	unsigned int raw_size    = 0;
+	unsigned int offset      = 0;
+
 	_synchros[file_id]->lock();
 	
 	//block header
-	int nbr = _files[file_id]->fread(nb_bytes_read, sizeof(*max_block_size),1);
-
-	if(nbr == 0)
+	if(readData(&stored_size, sizeof(stored_size), file_id) == 0)
 	{
 		//printf("__ end of file %i __\n",file_id);
 		_synchros[file_id]->unlock();
 		return 0;
 	}
 	
-	if(*nb_bytes_read > *max_block_size)
+	raw_size = stored_size;
+
+	//compressed block : read after the room needed for the raw block
+	if(_compressed)
 	{
-		*block = (unsigned char *) realloc(*block, *nb_bytes_read);
-		*max_block_size = *nb_bytes_read;
+		readData(&raw_size, sizeof(raw_size), file_id);
+		stored_size -= sizeof(raw_size);
+		offset = raw_size;
+	}
+
+	if(offset + stored_size > *max_block_size)
+	{
+		*block = (unsigned char *) realloc(*block, offset + stored_size);
+		*max_block_size = offset + stored_size;
 	}
 	
 	//block
-	_files[file_id]->fread(*block, sizeof(unsigned char),*nb_bytes_read);
+	readData(*block + offset, stored_size, file_id);
 	
 	_synchros[file_id]->unlock();
 	
+	if(_compressed)
+	{
+		uLongf size = raw_size;
+		if(uncompress(*block, &size, *block + offset, stored_size) != Z_OK || size != raw_size)
+		{
+			throw system::Exception ("unable to uncompress a superkmers block of partition %d", file_id);
+		}
+	}
+
+	*nb_bytes_read = raw_size;
+	
 	return *nb_bytes_read;
 }
 
@@ -422,6 +594,24 @@ void SuperKmerBinFiles::writeBlock(unsigned char * block, unsigned int block_siz
 	
 	_nbKmerperFile[file_id]+=nbkmers;
 	_FileSize[file_id] += block_size+sizeof(block_size);
+
+	if(_inMemory)
+	{
+		std::vector<u_int8_t>& mem = _memFiles[file_id];
+		mem.insert(mem.end(), (u_int8_t*)&block_size, (u_int8_t*)&block_size + sizeof(block_size));
+		mem.insert(mem.end(), block, block + block_size);
+
+		_synchros[file_id]->unlock();
+		return;
+	}
+
+	if(_writer!=0)
+	{
+		_synchros[file_id]->unlock();
+		_writer->post(block, block_size, file_id);
+		return;
+	}
+
 	//block header
 	_files[file_id]->fwrite(&block_size, sizeof(block_size),1);
 
@@ -434,6 +624,8 @@ void SuperKmerBinFiles::writeBlock(unsigned char * block, unsigned int block_siz
 	
 void SuperKmerBinFiles::flushFiles()
 {
+	waitWrites();
+
 	for(unsigned int ii=0;ii<_files.size();ii++)
 	{
 		_synchros[ii]->lock();
@@ -450,6 +642,13 @@ void SuperKmerBinFiles::flushFiles()
 
 void SuperKmerBinFiles::eraseFiles()
 {
+	if(_inMemory)
+	{
+		for(int ii=0;ii<_nb_files;ii++)  {  std::vector<u_int8_t>().swap(_memFiles[ii]);  }
+		system::impl::System::file().rmdir(_path);
+		return;
+	}
+
 	for(unsigned int ii=0;ii<_files.size();ii++)
 	{
 		std::stringstream ss;
@@ -462,6 +661,13 @@ void SuperKmerBinFiles::eraseFiles()
 
 void SuperKmerBinFiles::closeFile(  int fileId)
 {
+	//the partition has been read : release its buffer
+	if(_inMemory)
+	{
+		std::vector<u_int8_t>().swap(_memFiles[fileId]);
+		return;
+	}
+
 	if(_files[fileId]!=0)
 	{
 		delete _files[fileId];
@@ -473,6 +679,13 @@ void SuperKmerBinFiles::closeFile(  int fileId)
 	
 void SuperKmerBinFiles::closeFiles()
 {
+	//no more write once the files are closed : the writer thread is stopped
+	if(_writer!=0)
+	{
+		delete _writer;
+		_writer = 0;
+	}
+
 	for(unsigned int ii=0;ii<_files.size();ii++)
 	{
 		if(_files[ii]!=0)
@@ -488,6 +701,11 @@ SuperKmerBinFiles::~SuperKmerBinFiles()
 {
 	this->closeFiles();
 	this->eraseFiles();
+
+	if(_inMemory)
+	{
+		for(unsigned int ii=0;ii<_synchros.size();ii++)  {  _synchros[ii]->forget();  }
+	}
 }
 	
 int SuperKmerBinFiles::nbFiles()
@@ -522,6 +740,7 @@ CacheSuperKmerBinFiles::CacheSuperKmerBinFiles(SuperKmerBinFiles * ref, int buff
 		_buffers[ii] = (u_int8_t*) MALLOC (sizeof(u_int8_t) * _buffer_max_capacity);
 	}
 	
+	initCompression();
 }
 	
 //copy construc : alloc own buffer for new object
@@ -540,6 +759,27 @@ CacheSuperKmerBinFiles::CacheSuperKmerBinFiles (const CacheSuperKmerBinFiles& p)
 	{
 		_buffers[ii] = (u_int8_t*) MALLOC (sizeof(u_int8_t) * _buffer_max_capacity);
 	}
+
+	initCompression();
+}
+
+//each cache (ie. each thread) has its own deflate state, reused for all its blocks
+void CacheSuperKmerBinFiles::initCompression()
+{
+	_zstream = 0;
+
+	if(!_ref->isCompressed())  {  return;  }
+
+	_zstream = new z_stream;
+	memset(_zstream, 0, sizeof(z_stream));
+
+	//fastest level : 2-bit superkmers mostly compress through repeated superkmers
+	if(deflateInit(_zstream, Z_BEST_SPEED) != Z_OK)
+	{
+		throw system::Exception ("unable to initialize the compression of superkmers");
+	}
+
+	_packed.resize(sizeof(unsigned int) + deflateBound(_zstream, _buffer_max_capacity));
 }
 	
 void CacheSuperKmerBinFiles::flushAll()
@@ -556,7 +796,28 @@ void CacheSuperKmerBinFiles::flush(int file_id)
 {
 	if(_buffers_idx[file_id]!=0)
 	{
-		_ref->writeBlock(_buffers[file_id],_buffers_idx[file_id],file_id,_nbKmerperFile[file_id]);
+		if(_zstream != 0)
+		{
+			unsigned int raw_size = _buffers_idx[file_id];
+			memcpy(_packed.data(), &raw_size, sizeof(raw_size));
+
+			deflateReset(_zstream);
+			_zstream->next_in   = _buffers[file_id];
+			_zstream->avail_in  = raw_size;
+			_zstream->next_out  = _packed.data() + sizeof(raw_size);
+			_zstream->avail_out = _packed.size() - sizeof(raw_size);
+
+			if(deflate(_zstream, Z_FINISH) != Z_STREAM_END)
+			{
+				throw system::Exception ("unable to compress a superkmers block of partition %d", file_id);
+			}
+
+			_ref->writeBlock(_packed.data(),sizeof(raw_size) + _zstream->total_out,file_id,_nbKmerperFile[file_id]);
+		}
+		else
+		{
+			_ref->writeBlock(_buffers[file_id],_buffers_idx[file_id],file_id,_nbKmerperFile[file_id]);
+		}
 		
 		_buffers_idx[file_id]=0;
 		_nbKmerperFile[file_id] = 0;
@@ -586,6 +847,12 @@ CacheSuperKmerBinFiles::~CacheSuperKmerBinFiles()
 	{
 		FREE (_buffers[ii]);
 	}
+
+	if(_zstream != 0)
+	{
+		deflateEnd(_zstream);
+		delete _zstream;
+	}
 }
 /********************************************************************************/
 } } } } } /* end of namespaces. */
@@ -53,6 +53,9 @@
 #include <map>
 #include <cstring>
 
+/** zlib stream, for compressed superkmer files. */
+struct z_stream_s;
+
 /********************************************************************************/
 namespace gatb      {
 namespace core      {
@@ -243,6 +246,17 @@ protected:
 //the  block structure makes it easier for buffered read,
 //otherwise we would not know how to read a big chunk without stopping in the middle of superkmer
 
+//in memory mode, the blocks are appended to a RAM buffer per file instead of a temporary file
+//(same block structure, same read/write API) ; the buffer of a file is released by closeFile,
+//ie. once its partition has been read
+
+//in compressed mode, a block is < raw block size = 4B , deflate stream of the raw block >
+//it is compressed by CacheSuperKmerBinFiles, and uncompressed by readBlock out of the file lock,
+//so that the threads reading a file overlap the decompression with the reads of the others
+
+//in async mode, writeBlock only queues a copy of the block ; a dedicated writer thread does all the
+//writes, so the filling threads don't wait for write syscalls (unless the queue is full)
+
 class SuperKmerBinFiles
 {
 	
@@ -250,7 +264,7 @@ public:
 	
 	//construtor will open the files for writing
 	//use closeFiles to close them all then openFiles to open in different mode
-	SuperKmerBinFiles(const std::string& path,const std::string& name, size_t nb_files);
+	SuperKmerBinFiles(const std::string& path,const std::string& name, size_t nb_files, bool inMemory=false, bool compressed=false, bool asyncWrites=false);
 	
 	~SuperKmerBinFiles();
 
@@ -274,8 +288,20 @@ public:
 
 	
 	std::string getFileName(int fileId);
+
+	bool isInMemory()  { return _inMemory; }
+	bool isCompressed()  { return _compressed; }
 private:
 
+	//read some bytes of a file (the lock must be held) ; returns 0 at the end of the file
+	int readData(void* data, unsigned int nb_bytes, int file_id);
+
+	//wait for the queued blocks to be written (async mode)
+	void waitWrites();
+
+	struct AsyncWriter;
+	AsyncWriter* _writer;
+
 	std::string _basefilename;
 	std::string _path;
 	
@@ -285,6 +311,11 @@ private:
 	std::vector<system::IFile* > _files;
 	std::vector <system::ISynchronizer*> _synchros;
 	int _nb_files;
+
+	bool _inMemory;
+	bool _compressed;
+	std::vector< std::vector<u_int8_t> > _memFiles;
+	std::vector<u_int64_t> _memReadPos;
 };
 
 
@@ -312,6 +343,11 @@ private:
 	std::vector<int> _buffers_idx;
 	std::vector<int> _nbKmerperFile;
 
+	//deflate state and output buffer, when the superkmer files are compressed
+	::z_stream_s* _zstream;
+	std::vector<u_int8_t> _packed;
+
+	void initCompression();
 };
 	
 	
@@ -35,8 +35,11 @@
 
 #include <gatb/tools/storage/impl/Storage.hpp>
 #include <gatb/tools/collections/impl/Bloom.hpp>
+#include <gatb/tools/collections/impl/QuotientFilter.hpp>
 #include <gatb/tools/collections/impl/ContainerSet.hpp>
 
+#include <stdlib.h>
+
 
 /********************************************************************************/
 namespace gatb      {
@@ -156,6 +159,58 @@ public:
         return bloom;
     }
 
+    /** Save a quotient filter into a group
+     * \param[in] group : group where the filter has to be saved
+     * \param[in] name : name of the filter in the group
+     * \param[in] filter : quotient filter to be saved
+     */
+    template<typename T>  void saveQuotientFilter (Group& group, const std::string& name, collections::impl::QuotientFilter<T>* filter)
+    {
+        collections::Collection<math::NativeInt8>* filterCollection = & group.getCollection<math::NativeInt8> (name);
+
+        {
+            tools::storage::impl::Storage::ostream os (group, name);
+            os.write (reinterpret_cast<char const*>(filter->getArray()), filter->getSize());
+            os.flush();
+        }
+
+        std::stringstream ss1;  ss1 <<  filter->getQuotientBits();
+        std::stringstream ss2;  ss2 <<  filter->getRemainderBits();
+        std::stringstream ss3;  ss3 <<  filter->getCounterBits();
+        std::stringstream ss4;  ss4 <<  filter->getSeed();
+        std::stringstream ss5;  ss5 <<  filter->getNbItems();
+
+        filterCollection->addProperty ("quotient_bits",  ss1.str());
+        filterCollection->addProperty ("remainder_bits", ss2.str());
+        filterCollection->addProperty ("counter_bits",   ss3.str());
+        filterCollection->addProperty ("seed",           ss4.str());
+        filterCollection->addProperty ("nb_items",       ss5.str());
+        filterCollection->flush ();
+    }
+
+    /** Load a quotient filter from a group
+     * \param[in] group : group where the filter is
+     * \param[in] name : name of the filter in the group
+     * \return the loaded quotient filter
+     */
+    template<typename T>  collections::impl::QuotientFilter<T>*  loadQuotientFilter (Group& group, const std::string& name)
+    {
+        collections::Collection<math::NativeInt8>* filterCollection = & group.getCollection<math::NativeInt8> (name);
+
+        collections::impl::QuotientFilter<T>* filter = new collections::impl::QuotientFilter<T> (
+            atol (filterCollection->getProperty("quotient_bits").c_str()),
+            atol (filterCollection->getProperty("remainder_bits").c_str()),
+            atol (filterCollection->getProperty("counter_bits").c_str()),
+            strtoull (filterCollection->getProperty("seed").c_str(), 0, 10)
+        );
+        filter->setNbItems (strtoull (filterCollection->getProperty("nb_items").c_str(), 0, 10));
+
+        tools::storage::impl::Storage::istream is (group, name);
+        is.read (reinterpret_cast<char*>(filter->getArray()), filter->getSize());
+
+        return filter;
+    }
+
 private:
 
     /** We keep the possibility to load/save Bloom filters in two different ways.
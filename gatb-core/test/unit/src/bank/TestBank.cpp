@@ -24,6 +24,7 @@
 
 #include <gatb/bank/impl/Bank.hpp>
 #include <gatb/bank/impl/BankHelpers.hpp>
+#include <gatb/bank/impl/GzipReader.hpp>
 
 #include <gatb/tools/designpattern/impl/IteratorHelpers.hpp>
 
@@ -85,6 +86,9 @@ class TestBank : public Test
         //        CPPUNIT_TEST_GATB (bank_datalinesize); // disabled since we're printing fasta in one line now (see "#if 1" in BankFasta)
         CPPUNIT_TEST_GATB (bank_registery_types);
         CPPUNIT_TEST_GATB (bank_checkPower2);
+        CPPUNIT_TEST_GATB (bank_parallelParser);
+        CPPUNIT_TEST_GATB (bank_gzipReader);
+        CPPUNIT_TEST_GATB (bank_binaryMapped);
 
     CPPUNIT_TEST_SUITE_GATB_END();
 
@@ -1092,6 +1096,164 @@ public:
         System::file().remove(filename);
         CPPUNIT_ASSERT (System::file().doesExist(filename) == false);
     }
+
+    /********************************************************************************/
+    void bank_parallelParser_aux (const string& filename, size_t nbThreads)
+    {
+        BankFasta bank (filename);
+
+        BankFasta::Iterator         itRef (bank);
+        BankFasta::ParallelIterator itPar (bank, nbThreads);
+
+        size_t nbSeq = 0;
+
+        /** We check that both iterators provide the same sequences in the same order. */
+        for (itRef.first(), itPar.first(); !itRef.isDone(); itRef.next(), itPar.next(), nbSeq++)
+        {
+            CPPUNIT_ASSERT (itPar.isDone() == false);
+            CPPUNIT_ASSERT (itPar->getIndex()   == itRef->getIndex());
+            CPPUNIT_ASSERT (itPar->getComment() == itRef->getComment());
+            CPPUNIT_ASSERT (itPar->getQuality() == itRef->getQuality());
+            CPPUNIT_ASSERT (itPar->toString()   == itRef->toString());
+        }
+        CPPUNIT_ASSERT (itPar.isDone() == true);
+        CPPUNIT_ASSERT (nbSeq > 0);
+    }
+
+    /** */
+    void bank_parallelParser ()
+    {
+        const char* filenames[] = { "sample1.fa", "sample1.fa.gz", "reads1.fa", "sample.fastq", "sample.fastq.gz", "sample.bgzf.fastq.gz" };
+
+        for (size_t i=0; i<ARRAY_SIZE(filenames); i++)
+        {
+            bank_parallelParser_aux (DBPATH(filenames[i]), 1);
+            bank_parallelParser_aux (DBPATH(filenames[i]), 4);
+        }
+    }
+
+    /********************************************************************************/
+    string bank_gzipReader_aux (const string& filename, size_t nbThreads, GzipReader::Kind_e kind)
+    {
+        GzipReader reader (filename, nbThreads);
+        CPPUNIT_ASSERT (reader.isOpen() == true);
+        CPPUNIT_ASSERT (reader.getKind() == kind);
+
+        string content;
+        char   buffer[100];
+
+        /** We read the file twice in order to check 'rewind'. */
+        for (size_t loop=0; loop<2; loop++)
+        {
+            content.clear();
+            reader.rewind();
+
+            int nbRead;
+            while ((nbRead = reader.read (buffer, sizeof(buffer))) > 0)  {  content.append (buffer, nbRead);  }
+
+            CPPUNIT_ASSERT (nbRead == 0);
+            CPPUNIT_ASSERT (reader.tell() == content.size());
+        }
+
+        return content;
+    }
+
+    /** */
+    void bank_gzipReader ()
+    {
+        string ref = bank_gzipReader_aux (DBPATH("sample.fastq"), 1, GzipReader::UNCOMPRESSED);
+        CPPUNIT_ASSERT (ref.size() > 0);
+
+        for (size_t nbThreads=1; nbThreads<=4; nbThreads++)
+        {
+            CPPUNIT_ASSERT (bank_gzipReader_aux (DBPATH("sample.fastq.gz"),      nbThreads, GzipReader::GZIP) == ref);
+            CPPUNIT_ASSERT (bank_gzipReader_aux (DBPATH("sample.bgzf.fastq.gz"), nbThreads, GzipReader::BGZF) == ref);
+        }
+
+        CPPUNIT_ASSERT (GzipReader("dummy_unknown_file").isOpen() == false);
+    }
+
+    /********************************************************************************/
+    string bank_binaryMapped_key (Sequence& seq)
+    {
+        /** We get the packed nucleotides and the number of nucleotides. */
+        size_t len = seq.getDataSize();
+        return string (seq.getDataBuffer(), seq.getData().getBufferLength()) + string ((char*)&len, sizeof(len));
+    }
+
+    void bank_binaryMapped_aux (const string& filename)
+    {
+        string filenameBin = filename + ".bin";
+
+        /** We use small blocks in order to have several of them. */
+        BankBinary::setBufferSize (1000);
+
+        /** We convert the fasta bank in binary format. */
+        BankFasta  bank1 (filename);
+        BankBinary bank2 (filenameBin);
+        BankFasta::Iterator itSeq1 (bank1);
+        for (itSeq1.first(); !itSeq1.isDone(); itSeq1.next())   {  bank2.insert (*itSeq1);  }   bank2.flush ();
+
+        BankBinary::setBufferSize (100000);
+
+        /** We get the sequences through buffered I/O. */
+        vector<string> seqs;
+        BankBinary::Iterator it1 (bank2);
+        for (it1.first(); !it1.isDone(); it1.next())
+        {
+            CPPUNIT_ASSERT (it1->getIndex() == seqs.size());
+            seqs.push_back (bank_binaryMapped_key (*it1));
+        }
+
+        size_t nbBlocks = bank2.getNbBlocks();
+        CPPUNIT_ASSERT (nbBlocks > 1);
+
+        /** We check the whole mapped bank. */
+        size_t idx = 0;
+        BankBinary::MappedIterator it2 (bank2);
+        for (it2.first(); !it2.isDone(); it2.next(), idx++)
+        {
+            CPPUNIT_ASSERT (it2->getDataEncoding() == Data::BINARY);
+            CPPUNIT_ASSERT (it2->getIndex() == idx);
+            CPPUNIT_ASSERT (bank_binaryMapped_key (*it2) == seqs[idx]);
+        }
+        CPPUNIT_ASSERT (idx == seqs.size());
+
+        /** We check ranges of blocks; they must cover the bank in the same order. */
+        idx = 0;
+        for (size_t b=0; b<nbBlocks; b+=3)
+        {
+            Iterator<Sequence>* it3 = bank2.iterator (b, 3);  LOCAL (it3);
+            for (it3->first(); !it3->isDone(); it3->next(), idx++)
+            {
+                CPPUNIT_ASSERT (it3->item().getIndex() == idx);
+                CPPUNIT_ASSERT (bank_binaryMapped_key (it3->item()) == seqs[idx]);
+            }
+        }
+        CPPUNIT_ASSERT (idx == seqs.size());
+
+        /** A range beyond the last block is empty. */
+        Iterator<Sequence>* it4 = bank2.iterator (nbBlocks, 1);  LOCAL (it4);
+        it4->first();
+        CPPUNIT_ASSERT (it4->isDone());
+
+        /** We check the exact estimation given by the blocks index. */
+        BankBinary::setMemoryMapped (true);
+        u_int64_t number, totalSize, maxSize;
+        bank2.estimate (number, totalSize, maxSize);
+        CPPUNIT_ASSERT (number == seqs.size());
+        CPPUNIT_ASSERT (bank2.getNbItems() == (int64_t)seqs.size());
+        BankBinary::setMemoryMapped (false);
+
+        bank2.remove ();
+    }
+
+    /** */
+    void bank_binaryMapped ()
+    {
+        bank_binaryMapped_aux (DBPATH("reads1.fa"));
+        bank_binaryMapped_aux (DBPATH("reads2.fa"));
+    }
 };
 
 /********************************************************************************/
@@ -91,6 +91,7 @@ class TestDebruijn : public Test
         CPPUNIT_TEST_GATB (debruijn_large_abundance_query);
         CPPUNIT_TEST_GATB (debruijn_test7); 
         CPPUNIT_TEST_GATB (debruijn_deletenode);
+        CPPUNIT_TEST_GATB (debruijn_deletenode_state);
         //CPPUNIT_TEST_GATB (debruijn_checksum); // FIXME removed it because it's a damn long test
         CPPUNIT_TEST_GATB (debruijn_test2);
         CPPUNIT_TEST_GATB (debruijn_test3); // that one is long when compiled in debug, fast in release
@@ -1203,6 +1204,34 @@ public:
         debruijn_deletenode_fct (graph2);
     }
 
+    /********************************************************************************/
+    void debruijn_deletenode_state ()
+    {
+        Graph graph = Graph::create (new BankStrings ("AGGCGTTAC", "ACTGACTGACTGACTG",0),  "-kmer-size 5  -abundance-min 1  -verbose 0  -max-memory %d", MAX_MEMORY);
+
+        Node n1 = graph.buildNode ((char*)"AGGCG");
+        Node n2 = graph.buildNode ((char*)"GGCGT");
+        Node n3 = graph.buildNode ((char*)"GCGTT");
+
+        CPPUNIT_ASSERT (graph.contains(n1) && graph.contains(n2) && graph.contains(n3));
+
+        /** A deleted node is no more in the graph, the others are still there. */
+        graph.deleteNode (n2);
+        CPPUNIT_ASSERT (graph.contains(n1) && !graph.contains(n2) && graph.contains(n3));
+        CPPUNIT_ASSERT (graph.neighbors(n1).size() == 0);
+        CPPUNIT_ASSERT (graph.neighbors(n3).size() == 1);
+
+        /** The node comes back when its state is reset, although it remains in the filter of deleted nodes. */
+        graph.setNodeState (n2, 0);
+        CPPUNIT_ASSERT (graph.contains(n2));
+        CPPUNIT_ASSERT (graph.neighbors(n2).size() == 2);
+
+        graph.deleteNode (n3);
+        CPPUNIT_ASSERT (!graph.contains(n3));
+        graph.resetNodeState ();
+        CPPUNIT_ASSERT (graph.contains(n1) && graph.contains(n2) && graph.contains(n3));
+    }
+
     void debruijn_deletenode2_fct (const Graph& graph) 
     {
         Node n1 = graph.buildNode ((char*)"AGGCG");
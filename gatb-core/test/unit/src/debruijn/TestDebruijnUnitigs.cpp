@@ -95,6 +95,7 @@ class TestDebruijnUnitigs : public Test
         CPPUNIT_TEST_GATB (debruijn_unitigs_test7_nocircular);
         CPPUNIT_TEST_GATB (debruijn_unitigs_test10); // a unitig of length k with 2 in-branching and 2 out-branching. useful to test an edge case bug
         CPPUNIT_TEST_GATB (debruijn_unitigs_test11); // same as test10, except 1 out-branching instead of 2, provides asymetry
+        CPPUNIT_TEST_GATB (debruijn_unitigs_snapshot); // same data as test10, unitigs saved and loaded back from a binary snapshot
         CPPUNIT_TEST_GATB (debruijn_unitigs_test1); // an X-shaped unitig layout
         CPPUNIT_TEST_GATB (debruijn_unitigs_test14); // a neighborsEdge() without dir
         // the rest of those tests don't really test the getEdge function
@@ -563,6 +564,43 @@ public:
 
     };
 
+    void debruijn_unitigs_snapshot()
+    {
+        GraphUnitigs graph2 = GraphUnitigs::create (new BankStrings ("AGGCGA", "TTGCGA", "GCGAT", "CGATA", (char*)0),  "-kmer-size 5  -abundance-min 1  -verbose 0 -max-memory %d -out dummy -minimizer-size 3 -nb-cores 1", MAX_MEMORY);
+
+        GraphUnitigs graph = GraphUnitigs::create (new BankStrings ("AGGCGA", "TTGCGA", "GCGAT", "CGATA", "CGATT", (char*)0),  "-kmer-size 5  -abundance-min 1  -verbose 0 -max-memory %d -out dummy -minimizer-size 3 -nb-cores 1", MAX_MEMORY);
+
+        string snapshot = "dummy.unitigs.fa.snapshot";
+        u_int64_t unitigs_file_size = System::file().getSize ("dummy.unitigs.fa");
+        graph.save_unitigs_snapshot (snapshot, unitigs_file_size);
+
+        /** We load the snapshot in place of the unitigs of the other graph. */
+        CPPUNIT_ASSERT (graph2.load_unitigs_snapshot (snapshot, unitigs_file_size + 1) == false);
+        CPPUNIT_ASSERT (graph2.load_unitigs_snapshot (snapshot, unitigs_file_size) == true);
+
+        CPPUNIT_ASSERT (graph2.nb_unitigs             == graph.nb_unitigs);
+        CPPUNIT_ASSERT (graph2.nb_unitigs_extremities == graph.nb_unitigs_extremities);
+        CPPUNIT_ASSERT (graph2.incoming               == graph.incoming);
+        CPPUNIT_ASSERT (graph2.outcoming              == graph.outcoming);
+        CPPUNIT_ASSERT (graph2.packed_unitigs         == graph.packed_unitigs);
+        CPPUNIT_ASSERT (graph2.unitigs_sizes          == graph.unitigs_sizes);
+        CPPUNIT_ASSERT (graph2.unitigs_mean_abundance == graph.unitigs_mean_abundance);
+        for (u_int64_t i=0; i<graph.nb_unitigs; i++)
+        {
+            CPPUNIT_ASSERT (graph2.dag_incoming_map[i]     == graph.dag_incoming_map[i]);
+            CPPUNIT_ASSERT (graph2.dag_outcoming_map[i]    == graph.dag_outcoming_map[i]);
+            CPPUNIT_ASSERT (graph2.packed_unitigs_sizes[i] == graph.packed_unitigs_sizes[i]);
+        }
+
+        NodeGU n1 = graph2.debugBuildNode ((char*)"GCGAT");
+        CPPUNIT_ASSERT (graph2.neighborsEdge(n1, DIR_OUTCOMING).size() == 2);
+        CPPUNIT_ASSERT (graph2.neighborsEdge(n1, DIR_INCOMING).size()  == 2);
+
+        /** The snapshot is removed when the unitigs are built again. */
+        GraphUnitigs graph3 = GraphUnitigs::create (new BankStrings ("AGGCGA", (char*)0),  "-kmer-size 5  -abundance-min 1  -verbose 0 -max-memory %d -out dummy -minimizer-size 3 -nb-cores 1", MAX_MEMORY);
+        CPPUNIT_ASSERT (System::file().doesExist (snapshot) == false);
+    }
+
     void debruijn_unitigs_test11()
     {
         GraphUnitigs graph = GraphUnitigs::create (new BankStrings ("AGGCGA", "TTGCGA", "GCGAT", "CGATA", (char*)0),  "-kmer-size 5  -abundance-min 1  -verbose 0 -max-memory %d -out dummy -minimizer-size 3 -nb-cores 1", MAX_MEMORY);
@@ -28,6 +28,7 @@
 #include <gatb/kmer/impl/SortingCountAlgorithm.hpp>
 #include <gatb/kmer/impl/Model.hpp>
 #include <gatb/kmer/impl/BankKmers.hpp>
+#include <gatb/kmer/impl/RadixSort.hpp>
 
 #include <gatb/tools/misc/api/Macros.hpp>
 #include <gatb/tools/misc/impl/Property.hpp>
@@ -102,6 +103,11 @@ class TestDSK : public Test
         CPPUNIT_TEST_GATB (DSK_perBank2);
         CPPUNIT_TEST_GATB (DSK_perBankKmer);
         CPPUNIT_TEST_GATB (DSK_multibank);
+        CPPUNIT_TEST_GATB (DSK_radixSort);
+        CPPUNIT_TEST_GATB (DSK_pipeline);
+        CPPUNIT_TEST_GATB (DSK_inMemory);
+        CPPUNIT_TEST_GATB (DSK_compressPartitions);
+        CPPUNIT_TEST_GATB (DSK_asyncWrites);
 		 
 
     CPPUNIT_TEST_SUITE_GATB_END();
@@ -703,6 +709,204 @@ public:
 
         boost::mpl::for_each<gatb::core::tools::math::IntegerList>(DSK_multibank_aux());
     }
+    /********************************************************************************/
+    struct DSK_radixSort_aux  {  template<typename U> void operator() (U)
+    {
+        typedef typename Kmer<U::value>::Type Type;
+
+        size_t kmerSize = U::value-1;
+        size_t nbItems  = 20000;
+
+        /** We build random kmers, with few distinct values in order to get duplicates
+         * and with the bank id of each kmer computed from its value. */
+        srand (U::value);
+
+        vector<Type>      kmers (nbItems);
+        vector<u_int8_t>  ids   (nbItems);
+        for (size_t i=0; i<nbItems; i++)
+        {
+            Type val;  val.setVal (0);
+            for (size_t j=0; j<kmerSize; j++)  {  val = (val << 2) + (rand() % 4);  }
+            if (i>0 && i%3 == 0)  {  val = kmers[rand() % i];  }
+            kmers[i] = val;
+            ids  [i] = val.getVal() % 256;
+        }
+
+        vector<Type> check (kmers);
+        std::sort (check.begin(), check.end());
+
+        /** Like in PartitionsCommand, the number of bits may exceed the size of the kmer type. */
+        RadixSort<Type,u_int8_t>::sort (kmers.data(), ids.data(), nbItems, 2*(kmerSize+4));
+
+        for (size_t i=0; i<nbItems; i++)
+        {
+            CPPUNIT_ASSERT (kmers[i] == check[i]);
+            CPPUNIT_ASSERT (ids[i]   == kmers[i].getVal() % 256);
+        }
+    }};
+
+    void DSK_radixSort ()
+    {
+        boost::mpl::for_each<gatb::core::tools::math::IntegerList>(DSK_radixSort_aux());
+    }
+    /********************************************************************************/
+    void DSK_pipeline_aux (const vector<string>& sequences, bool pipeline, size_t& nbPasses, size_t& nbSolids, u_int64_t& checksum)
+    {
+        typedef Kmer<KSIZE_1>::Count Count;
+
+        /** We configure parameters for a SortingCountAlgorithm object; we use a tiny disk space
+         * in order to have several passes. */
+        IProperties* params = SortingCountAlgorithm<>::getDefaultProperties();  LOCAL (params);
+        params->setInt (STR_KMER_SIZE,          21);
+        params->setInt (STR_MAX_MEMORY,         MAX_MEMORY);
+        params->setInt (STR_MAX_DISK,           1);
+        params->setInt (STR_KMER_ABUNDANCE_MIN, 1);
+        params->setStr (STR_URI_OUTPUT,         "foo");
+        if (pipeline)  {  params->add (0, STR_PIPELINE_PASSES);  }
+
+        /** We create a DSK instance. */
+        SortingCountAlgorithm<> dsk (new BankStrings (sequences), params);
+
+        /** We launch DSK. */
+        dsk.execute();
+
+        nbPasses = dsk.getConfig()._nb_passes;
+        nbSolids = dsk.getInfo()->getInt("kmers_nb_solid");
+
+        checksum = 0;
+        Iterator<Count>* it = dsk.getSolidCounts()->iterator();  LOCAL (it);
+        for (it->first(); !it->isDone(); it->next())  {  checksum += hash1 (it->item().value, 0) * it->item().abundance;  }
+    }
+
+    void DSK_pipeline ()
+    {
+        /** We build random sequences with some repeats. */
+        srand (0);
+        const char* nt = "ACGT";
+
+        vector<string> sequences;
+        for (size_t i=0; i<6000; i++)
+        {
+            string seq;
+            for (size_t j=0; j<150; j++)  {  seq += nt[rand()%4];  }
+            sequences.push_back (seq);
+            if (i%5 == 0)  { sequences.push_back (seq); }
+        }
+
+        size_t    nbPasses[2], nbSolids[2];
+        u_int64_t checksum[2];
+
+        DSK_pipeline_aux (sequences, false, nbPasses[0], nbSolids[0], checksum[0]);
+        DSK_pipeline_aux (sequences, true,  nbPasses[1], nbSolids[1], checksum[1]);
+
+        CPPUNIT_ASSERT (nbPasses[0] > 1);
+        CPPUNIT_ASSERT (nbPasses[1] >= nbPasses[0]);
+        CPPUNIT_ASSERT (nbSolids[0] == nbSolids[1]);
+        CPPUNIT_ASSERT (checksum[0] == checksum[1]);
+    }
+
+    /********************************************************************************/
+    void DSK_partitions_aux (const vector<string>& sequences, const vector<const char*>& flags, bool& inMemory, size_t& nbSolids, u_int64_t& checksum)
+    {
+        typedef Kmer<KSIZE_1>::Count Count;
+
+        IProperties* params = SortingCountAlgorithm<>::getDefaultProperties();  LOCAL (params);
+        params->setInt (STR_KMER_SIZE,          21);
+        params->setInt (STR_MAX_MEMORY,         MAX_MEMORY);
+        params->setInt (STR_KMER_ABUNDANCE_MIN, 2);
+        params->setStr (STR_URI_OUTPUT,         "foo");
+        for (size_t i=0; i<flags.size(); i++)  {  params->add (0, flags[i]);  }
+
+        SortingCountAlgorithm<> dsk (new BankStrings (sequences), params);
+
+        dsk.execute();
+
+        inMemory = dsk.getConfig()._inMemoryPartitions;
+        nbSolids = dsk.getInfo()->getInt("kmers_nb_solid");
+
+        checksum = 0;
+        Iterator<Count>* it = dsk.getSolidCounts()->iterator();  LOCAL (it);
+        for (it->first(); !it->isDone(); it->next())  {  checksum += hash1 (it->item().value, 0) * it->item().abundance;  }
+    }
+
+    void DSK_partitions_sequences (vector<string>& sequences)
+    {
+        /** We build random sequences, a third of them being repeated. */
+        srand (1);
+        const char* nt = "ACGT";
+
+        for (size_t i=0; i<3000; i++)
+        {
+            string seq;
+            for (size_t j=0; j<100; j++)  {  seq += nt[rand()%4];  }
+            sequences.push_back (seq);
+            if (i%3 == 0)  { sequences.push_back (seq); }
+        }
+    }
+
+    void DSK_inMemory ()
+    {
+        vector<string> sequences;
+        DSK_partitions_sequences (sequences);
+
+        bool      inMemory[2];
+        size_t    nbSolids[2];
+        u_int64_t checksum[2];
+
+        DSK_partitions_aux (sequences, { STR_DISK_PARTITIONS }, inMemory[0], nbSolids[0], checksum[0]);
+        DSK_partitions_aux (sequences, { },                     inMemory[1], nbSolids[1], checksum[1]);
+
+        CPPUNIT_ASSERT (inMemory[0] == false);
+        CPPUNIT_ASSERT (inMemory[1] == true);
+        CPPUNIT_ASSERT (nbSolids[0] == 1000*80);
+        CPPUNIT_ASSERT (nbSolids[0] == nbSolids[1]);
+        CPPUNIT_ASSERT (checksum[0] == checksum[1]);
+    }
+
+    /********************************************************************************/
+    void DSK_compressPartitions ()
+    {
+        vector<string> sequences;
+        DSK_partitions_sequences (sequences);
+
+        bool      inMemory[3];
+        size_t    nbSolids[3];
+        u_int64_t checksum[3];
+
+        /** We count from raw files, compressed files and compressed memory buffers. */
+        DSK_partitions_aux (sequences, { STR_DISK_PARTITIONS },                          inMemory[0], nbSolids[0], checksum[0]);
+        DSK_partitions_aux (sequences, { STR_DISK_PARTITIONS, STR_COMPRESS_PARTITIONS }, inMemory[1], nbSolids[1], checksum[1]);
+        DSK_partitions_aux (sequences, { STR_COMPRESS_PARTITIONS },                      inMemory[2], nbSolids[2], checksum[2]);
+
+        CPPUNIT_ASSERT (inMemory[2] == true);
+
+        for (size_t i=1; i<3; i++)
+        {
+            CPPUNIT_ASSERT (nbSolids[i] == nbSolids[0]);
+            CPPUNIT_ASSERT (checksum[i] == checksum[0]);
+        }
+    }
+
+    /********************************************************************************/
+    void DSK_asyncWrites ()
+    {
+        vector<string> sequences;
+        DSK_partitions_sequences (sequences);
+
+        bool      inMemory[3];
+        size_t    nbSolids[3];
+        u_int64_t checksum[3];
+
+        DSK_partitions_aux (sequences, { STR_DISK_PARTITIONS },                                            inMemory[0], nbSolids[0], checksum[0]);
+        DSK_partitions_aux (sequences, { STR_DISK_PARTITIONS, STR_ASYNC_WRITES },                          inMemory[1], nbSolids[1], checksum[1]);
+        DSK_partitions_aux (sequences, { STR_DISK_PARTITIONS, STR_ASYNC_WRITES, STR_COMPRESS_PARTITIONS }, inMemory[2], nbSolids[2], checksum[2]);
+
+        for (size_t i=1; i<3; i++)
+        {
+            CPPUNIT_ASSERT (nbSolids[i] == nbSolids[0]);
+            CPPUNIT_ASSERT (checksum[i] == checksum[0]);
+        }
+    }
 };
 
 /********************************************************************************/
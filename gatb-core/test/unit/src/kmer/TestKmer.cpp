@@ -74,9 +74,11 @@ class TestKmer : public Test
         CPPUNIT_TEST_GATB (kmer_checkCompute);
         CPPUNIT_TEST_GATB (kmer_checkIterator);
         CPPUNIT_TEST_GATB (kmer_build);
+        CPPUNIT_TEST_GATB (kmer_buildBatch);
         CPPUNIT_TEST_GATB (kmer_minimizer); // with ModelDirect
         CPPUNIT_TEST_GATB (kmer_minimizer2); // with ModelDirect
         CPPUNIT_TEST_GATB (kmer_minimizer3); // with ModelCanonical
+        CPPUNIT_TEST_GATB (kmer_minimizer4); // large mmers and frequency order
         CPPUNIT_TEST_GATB (kmer_badchar);
 
     CPPUNIT_TEST_SUITE_GATB_END();
@@ -260,6 +262,82 @@ public:
         CPPUNIT_ASSERT (kmer.value() == check[0]);
     }
 
+    /********************************************************************************/
+    template<size_t span>
+    void kmer_buildBatch_aux (Data& data, size_t kmerSize)
+    {
+        typedef typename Kmer<span>::ModelCanonical  ModelCanonical;
+        typedef typename Kmer<span>::Type            Type;
+
+        ModelCanonical model (kmerSize);
+
+        /** The reference is the kmers built one at a time. */
+        vector<typename ModelCanonical::Kmer> kmers;
+        model.build (data, kmers);
+
+        vector<Type>      forward (data.size()), revcomp (data.size()), canonical (data.size());
+        vector<u_int64_t> invalid (data.size()/64 + 1);
+
+        size_t nbKmers = model.buildBatch (data, forward.data(), revcomp.data(), canonical.data(), invalid.data());
+        CPPUNIT_ASSERT (nbKmers == kmers.size());
+
+        for (size_t i=0; i<nbKmers; i++)
+        {
+            CPPUNIT_ASSERT (forward[i]   == kmers[i].forward());
+            CPPUNIT_ASSERT (revcomp[i]   == kmers[i].revcomp());
+            CPPUNIT_ASSERT (canonical[i] == kmers[i].value());
+            CPPUNIT_ASSERT ((((invalid[i/64] >> (i%64)) & 1) == 0) == kmers[i].isValid());
+        }
+
+        /** Outputs may be omitted. */
+        CPPUNIT_ASSERT (model.buildBatch (data, 0, 0, canonical.data()) == nbKmers);
+        CPPUNIT_ASSERT (canonical[nbKmers-1] == kmers[nbKmers-1].value());
+    }
+
+    /** */
+    void kmer_buildBatch ()
+    {
+        const char* nt = "ACTG";
+
+        /** A sequence with bad nucleotides and lower case ones, and the same one as integer and binary data. */
+        srand (1);
+        string seq (300, 'A');
+        for (size_t i=0; i<seq.size(); i++)  { seq[i] = nt[rand()%4]; }
+        for (size_t i=0; i<seq.size(); i+=7)  { seq[i] = tolower(seq[i]); }
+
+        string seqN (seq);
+        seqN[0] = 'N';  seqN[40] = 'N';  seqN[41] = 'R';  seqN[150] = 'n';  seqN[299] = 'N';
+
+        Data ascii ((char*)seqN.c_str());
+
+        Data integer (seq.size(), Data::INTEGER);
+        Data binary  (seq.size(), Data::BINARY);
+        memset (binary.getBuffer(), 0, seq.size());
+        for (size_t i=0; i<seq.size(); i++)
+        {
+            char c = (seq[i]>>1) & 3;
+            integer[i]    = c;
+            binary [i/4] |= c << ((3-(i%4))*2);
+        }
+
+        Data* datas[] = { &ascii, &integer, &binary };
+
+        for (size_t d=0; d<ARRAY_SIZE(datas); d++)
+        {
+            kmer_buildBatch_aux<KMER_SPAN(0)> (*datas[d], 5);
+            kmer_buildBatch_aux<KMER_SPAN(0)> (*datas[d], 31);
+#if KSIZE_LIST == 32
+#else
+            kmer_buildBatch_aux<KMER_SPAN(1)> (*datas[d], 45);
+#endif
+        }
+
+        /** Data shorter than a kmer. */
+        Data shortData ((char*)"ACGT");
+        Kmer<>::ModelCanonical model (5);
+        CPPUNIT_ASSERT (model.buildBatch (shortData, 0, 0, 0) == 0);
+    }
+
     /********************************************************************************/
     template<size_t span>
     struct kmer_minimizer_fct
@@ -502,6 +580,107 @@ public:
     }
 
 
+    /********************************************************************************/
+    template<size_t span>
+    struct kmer_minimizer4_fct
+    {
+        typedef typename Kmer<span>::ModelCanonical ModelCanonical;
+        typedef typename Kmer<span>::template ModelMinimizer<ModelCanonical> ModelMinimizer;
+        typedef typename Kmer<span>::Type Type;
+
+        ModelMinimizer& model;
+        u_int32_t*      freq;
+        size_t&         nbKmers;
+
+        kmer_minimizer4_fct (ModelMinimizer& model, u_int32_t* freq, size_t& nbKmers)  : model(model), freq(freq), nbKmers(nbKmers) {}
+
+        void operator() (const typename ModelMinimizer::Kmer& kmers, size_t idx)
+        {
+            const ModelCanonical& modelMini = model.getMmersModel();
+            size_t miniSize = modelMini.getKmerSize();
+
+            string currentKmer = model.toString(kmers.value());
+
+            /** The default minimizer is the mmer of m 'G'. */
+            Type currentMini = modelMini.getKmerMax();
+
+            for (size_t i=0; i<model.getKmerSize() - miniSize + 1; i++)
+            {
+                Type mmer = modelMini.codeSeed (currentKmer.substr(i,miniSize).data(), Data::ASCII).value();
+
+                if (freq == 0)
+                {
+                    /** Lexicographic order: AA is forbidden inside the canonical mmer. */
+                    if (modelMini.toString(mmer).substr(1).find("AA") != string::npos)  { continue; }
+                    if (mmer < currentMini)  { currentMini = mmer; }
+                }
+                else
+                {
+                    u_int32_t f1 = freq[mmer.getVal()], f2 = freq[currentMini.getVal()];
+                    if (f1 < f2 || (f1 == f2 && mmer < currentMini))  { currentMini = mmer; }
+                }
+            }
+
+            CPPUNIT_ASSERT (currentMini == kmers.minimizer().value());
+            CPPUNIT_ASSERT (currentMini.getVal() == model.getMinimizerValue (kmers.value()));
+
+            nbKmers++;
+        }
+    };
+
+    /** */
+    template<size_t span>
+    void kmer_minimizer4_aux (IBank& bank, size_t kmerSize, size_t miniSize, u_int32_t* freq)
+    {
+        typename Kmer<span>::template ModelMinimizer <typename Kmer<span>::ModelCanonical> minimizerModel (
+            kmerSize, miniSize, typename Kmer<span>::ComparatorMinimizerFrequencyOrLex(), freq
+        );
+
+        size_t nbKmers = 0;
+        Iterator<Sequence>* itSeq = bank.iterator();  LOCAL (itSeq);
+
+        for (itSeq->first(); !itSeq->isDone(); itSeq->next())
+        {
+            minimizerModel.iterate ((*itSeq)->getData(), kmer_minimizer4_fct<span> (minimizerModel, freq, nbKmers));
+        }
+        CPPUNIT_ASSERT (nbKmers > 0);
+    }
+
+    /** Minimizers computed without lookup table: mmers up to 31 nucleotides, frequency order. */
+    void kmer_minimizer4 ()
+    {
+        vector<IBank*> banks;
+        banks.push_back (new BankStrings ("ACCATGTATAATTATAAGTAGGTACCTATTTTTTTATTTTAAACTGAAATTCAATATTATATAGGCAAAGAT"
+                                          "TCCCCAGGCCCCTACACCCAATGTGGAACCGGGGTCCCGAATGAAAATGCTGCTGTTCCCTGGAGGTGTTCT", NULL));
+        banks.push_back (new BankRandom (100, 200));
+
+        size_t miniSizes[] = { 10, 20, 31 };
+
+        /** Random frequencies of the 6-mers, with many ties. */
+        vector<u_int32_t> freq (1 << 12);
+        srand (1);
+        for (size_t i=0; i<freq.size(); i++)  { freq[i] = rand() % 50; }
+
+        static const size_t KSIZE_1 = KMER_SPAN(0);
+
+        for (size_t b=0; b<banks.size(); b++)
+        {
+            IBank* bank = banks[b];   LOCAL(bank);
+
+            for (size_t j=0; j<ARRAY_SIZE(miniSizes); j++)
+            {
+                kmer_minimizer4_aux<KSIZE_1> (*bank, 31, miniSizes[j], 0);
+#if KSIZE_32
+#else
+                kmer_minimizer4_aux<KMER_SPAN(1)> (*bank, 63, miniSizes[j], 0);
+#endif
+            }
+
+            kmer_minimizer4_aux<KSIZE_1> (*bank, 31, 6, &freq[0]);
+        }
+    }
+
+
     /********************************************************************************/
 
     typedef Kmer<>::ModelDirect  ModelDirect;
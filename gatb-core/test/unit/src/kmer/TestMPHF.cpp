@@ -74,6 +74,7 @@ class TestMPHF : public Test
 
         // no mphf1 anymore
         CPPUNIT_TEST_GATB (test_mphf2);
+        CPPUNIT_TEST_GATB (test_mphf_partitions);
 
     CPPUNIT_TEST_SUITE_GATB_END();
 
@@ -322,6 +323,60 @@ public:
             // We check that all codes have been seen
             for (size_t i=0; i<check.size(); i++)  { CPPUNIT_ASSERT(check[i]==true); }
         }
+
+    /********************************************************************************/
+    void test_mphf_partitions (void)
+    {
+        /** Shortcuts. */
+        typedef NativeInt64 Key;
+        typedef BooPHF<Key>   Hash;
+        typedef Hash::Code HashValue;
+
+        size_t nbParts = 8;
+        size_t nbKeys  = 0;
+
+        /** We create a storage. */
+        Storage storage (STORAGE_FILE, "mphf_parts");
+
+        /** We fill the partitions with distinct keys; one of them is left empty. */
+        Partition<Key>& partition = storage().getPartition<Key> ("keys", nbParts);
+        for (size_t i=0; i<partition.size(); i++)
+        {
+            if (i==3)  { continue; }
+            for (u_int64_t k=0; k<5000; k++, nbKeys++)  {  partition[i].insert (k*nbParts + i);  }
+        }
+        partition.flush();
+
+        CPPUNIT_ASSERT (partition.getNbItems() == (int64_t)nbKeys);
+
+        /** We build the hash function with several threads reading the partitions concurrently. */
+        Hash hash;
+        hash.build (&partition, 4);
+
+        CPPUNIT_ASSERT (hash.size() == nbKeys);
+
+        // We need a vector to check codes existence
+        vector<bool> check (nbKeys);
+
+        Iterator<Key>* itKeys = partition.iterator();  LOCAL (itKeys);
+
+        for (itKeys->first(); !itKeys->isDone(); itKeys->next())
+        {
+            // We get the hash code for the current key
+            HashValue code = hash (itKeys->item());
+
+            // We check we never saw that code before
+            CPPUNIT_ASSERT (code < nbKeys);
+            CPPUNIT_ASSERT (check[code]==false);
+            check[code]=true;
+        }
+
+        // We check that all codes have been seen
+        for (size_t i=0; i<check.size(); i++)  { CPPUNIT_ASSERT(check[i]==true); }
+
+        /** We delete the storage. */
+        storage.remove ();
+    }
 };
 
 /********************************************************************************/
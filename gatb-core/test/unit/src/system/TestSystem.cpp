@@ -23,6 +23,7 @@
 #include <gatb/system/impl/MemoryCommon.hpp>
 #include <gatb/system/impl/TimeCommon.hpp>
 #include <gatb/system/impl/FileSystemCommon.hpp>
+#include <gatb/system/impl/WorkerPool.hpp>
 
 #include <list>
 #include <stdlib.h>     /* srand, rand */
@@ -71,6 +72,7 @@ class TestSystem : public Test
         CPPUNIT_TEST_GATB (thread_checkTime);
         CPPUNIT_TEST_GATB (thread_checkSynchro);
         CPPUNIT_TEST_GATB (thread_exception);
+        CPPUNIT_TEST_GATB (thread_workerPool);
 
         CPPUNIT_TEST_GATB (filesystem_info);
         CPPUNIT_TEST_GATB (filesystem_create_delete);
@@ -722,6 +724,47 @@ public:
         delete synchro;
     }
 
+    /********************************************************************************/
+    void thread_workerPool ()
+    {
+        WorkerPool& pool = WorkerPool::singleton();
+
+        ISynchronizer* synchro = System::thread().newSynchronizer();
+
+        size_t nbCores = System::info().getNbCores();
+
+        /** We run the same job several times; the workers of the first run must be reused. */
+        size_t nbWorkers = 0;
+        for (size_t run=0; run<3; run++)
+        {
+            Data data (1000, synchro);
+
+            IThread* threads [nbCores];
+            for (size_t i=0; i<nbCores; i++)   {  threads[i] = pool.newThread (thread_checkSynchro_mainloop, &data);  }
+            for (size_t i=0; i<nbCores; i++)   {  threads[i]->join();    delete threads[i];  }
+
+            CPPUNIT_ASSERT (data.value == nbCores * data.nbIter);
+
+            if (run == 0)  { nbWorkers = pool.getNbWorkers(); }
+            CPPUNIT_ASSERT (pool.getNbWorkers() == nbWorkers);
+        }
+
+        /** Pinning the workers must not change the results. */
+        pool.setAffinity (WorkerPool::AFFINITY_CORES);
+        {
+            Data data (1000, synchro);
+
+            IThread* threads [nbCores];
+            for (size_t i=0; i<nbCores; i++)   {  threads[i] = pool.newThread (thread_checkSynchro_mainloop, &data);  }
+            for (size_t i=0; i<nbCores; i++)   {  threads[i]->join();    delete threads[i];  }
+
+            CPPUNIT_ASSERT (data.value == nbCores * data.nbIter);
+        }
+        pool.setAffinity (WorkerPool::AFFINITY_NONE);
+
+        delete synchro;
+    }
+
     /********************************************************************************/
     static void* thread_exception_mainloop (void* arg)
     {
@@ -20,6 +20,7 @@
 
 #define USE_LARGEINT_CONSTRUCTOR 1 // one of the only cases where LargeInt should be using its constructor; but got lazy to want to change the unit tests here.
 #include <gatb/tools/collections/impl/Bloom.hpp>
+#include <gatb/tools/collections/impl/QuotientFilter.hpp>
 
 #include <gatb/tools/misc/api/Macros.hpp>
 
@@ -31,6 +32,8 @@
 #include <time.h>       /* time */
 
 #include <set>
+#include <map>
+#include <vector>
 
 using namespace std;
 using namespace gatb::core::tools::collections;
@@ -51,6 +54,9 @@ class TestContainer : public Test
     CPPUNIT_TEST_SUITE_GATB (TestContainer);
 
         CPPUNIT_TEST_GATB (bloom_checkContains);
+        CPPUNIT_TEST_GATB (bloom_checkContainsN);
+        CPPUNIT_TEST_GATB (bloom_checkBlocked);
+        CPPUNIT_TEST_GATB (quotient_check);
 
     CPPUNIT_TEST_SUITE_GATB_END();
 
@@ -132,6 +138,167 @@ public:
         bloom_checkContains_aux<LargeInt<5> > (values2, ARRAY_SIZE(values2));
         bloom_checkContains_aux<LargeInt<5> > (values3, ARRAY_SIZE(values3));
     }
+
+    /********************************************************************************/
+    template<typename Item> void bloom_checkContainsN_aux (IBloom<Item>* bloom, size_t kmerSize)
+    {
+        LOCAL (bloom);
+
+        u_int64_t kmerMask = (kmerSize>=32 ? ~0ULL : (1ULL << (2*kmerSize)) - 1);
+
+        /** We insert some random kmers; half of the queried kmers are inserted ones. */
+        vector<Item> items (10*1000);
+        for (size_t i=0; i<items.size(); i++)
+        {
+            items[i].setVal ((((u_int64_t)rand() << 32) + rand()) & kmerMask);
+            if (i%2 == 0)  { bloom->insert (items[i]); }
+        }
+
+        /** We check that containsN gives the same answers as contains, whatever the number of queried items. */
+        for (size_t n=1; n<=items.size(); n*=3)
+        {
+            vector<char> found (n);
+            bloom->containsN (items.data(), n, (bool*)found.data());
+
+            for (size_t i=0; i<n; i++)
+            {
+                CPPUNIT_ASSERT ((found[i]!=0) == bloom->contains (items[i]));
+                if (i%2 == 0)  { CPPUNIT_ASSERT (found[i]); }
+            }
+        }
+    }
+
+    /** */
+    void bloom_checkContainsN ()
+    {
+        bloom_checkContainsN_aux<LargeInt<1> > (new Bloom<LargeInt<1> >                 (1000*1000),     31);
+        bloom_checkContainsN_aux<LargeInt<1> > (new BloomCacheCoherent<LargeInt<1> >    (1000*1000),     31);
+        bloom_checkContainsN_aux<LargeInt<1> > (new BloomNeighborCoherent<LargeInt<1> > (1000*1000, 31), 31);
+        bloom_checkContainsN_aux<LargeInt<1> > (new BloomBlocked<LargeInt<1> >          (1000*1000, 4, 31), 31);
+
+        bloom_checkContainsN_aux<LargeInt<2> > (new Bloom<LargeInt<2> >                 (1<<20),         45);
+        bloom_checkContainsN_aux<LargeInt<2> > (new BloomNeighborCoherent<LargeInt<2> > (1000*1000, 45), 45);
+    }
+
+    /********************************************************************************/
+    void bloom_checkBlocked ()
+    {
+        typedef LargeInt<1> Item;
+        size_t kmerSize = 31;
+
+        Item un;  un.setVal(1);
+        Item kmerMask = (un << (kmerSize*2)) - un;
+
+        BloomBlocked<Item> bloom (1000*1000, 4, kmerSize);
+
+        /** The size is rounded up to a number of cache lines. */
+        CPPUNIT_ASSERT (bloom.getBitSize() % 512 == 0);
+        CPPUNIT_ASSERT (bloom.getBitSize() >= 1000*1000);
+        CPPUNIT_ASSERT (bloom.getSize() * 8 == bloom.getBitSize());
+
+        /** We insert canonical kmers. */
+        vector<Item> kmers (20*1000);
+        for (size_t i=0; i<kmers.size(); i++)
+        {
+            Item kmer;  kmer.setVal ((((u_int64_t)rand() << 32) + rand()));
+            kmer = kmer & kmerMask;
+            Item rev = revcomp (kmer, kmerSize);
+            kmers[i] = std::min (kmer, rev);
+            bloom.insert (kmers[i]);
+        }
+
+        /** No false negative. */
+        for (size_t i=0; i<kmers.size(); i++)  {  CPPUNIT_ASSERT (bloom.contains (kmers[i]));  }
+
+        /** We check that contains8 gives the same answer than contains for each neighbor. */
+        for (size_t i=0; i<kmers.size(); i++)
+        {
+            bitset<8> mask = bloom.contains8 (kmers[i]);
+
+            for (u_int64_t nt=0; nt<4; nt++)
+            {
+                Item single_nt;  single_nt.setVal (nt);
+
+                Item right = ((kmers[i] << 2) + single_nt) & kmerMask;
+                Item left  = (kmers[i] >> 2) + (single_nt << ((kmerSize-1)*2));
+
+                CPPUNIT_ASSERT (mask[nt]   == bloom.contains (std::min (right, revcomp (right, kmerSize))));
+                CPPUNIT_ASSERT (mask[4+nt] == bloom.contains (std::min (left,  revcomp (left,  kmerSize))));
+            }
+        }
+
+        /** The bit set can be copied into another filter of the same size (as done by the storage). */
+        BloomBlocked<Item> copy (bloom.getBitSize(), bloom.getNbHash(), kmerSize);
+        CPPUNIT_ASSERT (copy.getSize() == bloom.getSize());
+        memcpy (copy.getArray(), bloom.getArray(), bloom.getSize());
+        for (size_t i=0; i<kmers.size(); i++)  {  CPPUNIT_ASSERT (copy.contains (kmers[i]));  }
+        CPPUNIT_ASSERT (copy.weight() == bloom.weight());
+    }
+
+    /********************************************************************/
+    void quotient_check ()
+    {
+        typedef NativeInt64 Item;
+
+        /** We start with a small filter, so it has to be resized several times; each resize
+         * takes one remainder bit, so we use long remainders for avoiding collisions. */
+        QuotientFilter<Item> filter (6, 40);
+
+        map<u_int64_t,u_int64_t> counts;
+        vector<u_int64_t>        values;
+
+        srand (1);
+        for (size_t i=0; i<50*1000; i++)
+        {
+            u_int64_t value = rand() % (100*1000);
+
+            if (rand()%4 != 0 || values.empty())
+            {
+                filter.insert (Item(value));
+                counts[value] ++;
+                values.push_back (value);
+            }
+            else
+            {
+                /** We remove an occurrence of a previously inserted item. */
+                u_int64_t removed = values [rand() % values.size()];
+                CPPUNIT_ASSERT (filter.remove (Item(removed)) == (counts[removed] > 0));
+                if (counts[removed] > 0)  { counts[removed] --; }
+            }
+        }
+
+        CPPUNIT_ASSERT (filter.getQuotientBits() > 6);
+        CPPUNIT_ASSERT (filter.getLoad() <= 0.9);
+
+        /** No false negative and counters are exact (up to fingerprint collisions, unlikely here). */
+        for (map<u_int64_t,u_int64_t>::iterator it = counts.begin(); it != counts.end(); ++it)
+        {
+            CPPUNIT_ASSERT (filter.getCount (Item(it->first)) == std::min (it->second, (u_int64_t)255));
+            CPPUNIT_ASSERT (filter.contains (Item(it->first)) == (it->second > 0));
+        }
+
+        /** containsN gives the same answers as contains. */
+        vector<Item> items;
+        for (u_int64_t value=0; value<1000; value++)  { items.push_back (Item(value)); }
+        bool found[1000];
+        filter.containsN (items.data(), items.size(), found);
+        for (size_t i=0; i<items.size(); i++)  {  CPPUNIT_ASSERT (found[i] == filter.contains (items[i]));  }
+
+        /** Each used slot is iterated once. */
+        u_int64_t nbSlots = 0;
+        filter.iterate ([&nbSlots] (u_int64_t fp, u_int64_t count)  { nbSlots++; });
+        CPPUNIT_ASSERT (nbSlots == filter.getNbItems());
+
+        /** The data can be copied into another filter of the same configuration (as done by the storage). */
+        QuotientFilter<Item> copy (filter.getQuotientBits(), filter.getRemainderBits(), filter.getCounterBits(), filter.getSeed());
+        CPPUNIT_ASSERT (copy.getSize() == filter.getSize());
+        memcpy (copy.getArray(), filter.getArray(), filter.getSize());
+        copy.setNbItems (filter.getNbItems());
+        for (map<u_int64_t,u_int64_t>::iterator it = counts.begin(); it != counts.end(); ++it)
+        {
+            CPPUNIT_ASSERT (copy.getCount (Item(it->first)) == filter.getCount (Item(it->first)));
+        }
+    }
 };
 
 /********************************************************************************/
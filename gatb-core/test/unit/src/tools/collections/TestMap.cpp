@@ -21,6 +21,7 @@
 #include <gatb/system/impl/System.hpp>
 #include <gatb/tools/designpattern/api/Iterator.hpp>
 #include <gatb/tools/collections/impl/OAHash.hpp>
+#include <gatb/tools/collections/impl/FlatHash.hpp>
 #include <gatb/tools/collections/impl/MapMPHF.hpp>
 #include <gatb/tools/math/NativeInt64.hpp>
 #include <gatb/tools/math/NativeInt128.hpp>
@@ -61,6 +62,7 @@ class TestMap : public Test
     CPPUNIT_TEST_SUITE_GATB (TestMap);
 
         CPPUNIT_TEST_GATB (checkOAHash);
+        CPPUNIT_TEST_GATB (checkFlatHash);
         CPPUNIT_TEST_GATB (checkMapMPHF);
 
     CPPUNIT_TEST_SUITE_GATB_END();
@@ -130,6 +132,68 @@ public:
         }
     }
 
+    /********************************************************************************/
+    template<typename T>
+    void checkFlatHash_aux (size_t nbKeys)
+    {
+        /** We create a small hash, so it has to grow and then to be full. */
+        FlatHash <T> hash (1);
+
+        /** We insert the key i (i%7+1) times, in a random order. */
+        vector<u_int64_t> keys;
+        for (size_t i=1; i<=nbKeys; i++)  {  for (size_t j=0; j<=i%7; j++)  {  keys.push_back (i*1000003);  }  }
+        random_shuffle (keys.begin(), keys.end());
+
+        for (size_t i=0; i<keys.size(); i++)  {  T key; key.setVal(keys[i]);  hash.insert (key);  }
+
+        CPPUNIT_ASSERT (hash.size() == nbKeys);
+
+        /** We check the counts of the registered keys and that we don't have a non registered key. */
+        for (size_t i=1; i<=nbKeys; i++)
+        {
+            T key; key.setVal (i*1000003);
+            int val = 0;
+            CPPUNIT_ASSERT (hash.get (key, &val) == true);
+            CPPUNIT_ASSERT (val == (int)(i%7+1));
+
+            key.setVal (i*1000003 + 1);
+            CPPUNIT_ASSERT (hash.get (key) == false);
+        }
+
+        /** We iterate the sorted map. */
+        Iterator <typename FlatHash<T>::cell>* it = hash.iterator (true);
+        LOCAL (it);
+
+        size_t nbItems = 0;
+        for (it->first(); !it->isDone(); it->next(), nbItems++)
+        {
+            CPPUNIT_ASSERT (it->item().graine.getVal() == (nbItems+1)*1000003);
+            CPPUNIT_ASSERT (it->item().val == (int)((nbItems+1)%7+1));
+        }
+        CPPUNIT_ASSERT (nbItems == nbKeys);
+
+        /** We clear the map, it can be used again. */
+        hash.clear ();
+        CPPUNIT_ASSERT (hash.size() == 0);
+        CPPUNIT_ASSERT (hash.isFull() == false);
+
+        T key; key.setVal (1000003);
+        hash.insert (key);
+        CPPUNIT_ASSERT (hash.get (key) == true);
+    }
+
+    /********************************************************************************/
+    void checkFlatHash ()
+    {
+        size_t table[] = { 10, 1000, 100*1000};
+
+        for (size_t i=0; i<ARRAY_SIZE(table); i++)
+        {
+            checkFlatHash_aux<NativeInt64>  (table[i]);
+            checkFlatHash_aux<LargeInt<3> > (table[i]);
+        }
+    }
+
     /********************************************************************************/
     static void checkMapMPHF_progress (size_t round, size_t initial, size_t remaining)
     {
@@ -19,6 +19,7 @@
 #include <CppunitCommon.hpp>
 
 #include <gatb/tools/designpattern/impl/IteratorHelpers.hpp>
+#include <gatb/tools/designpattern/impl/Command.hpp>
 
 #include <gatb/tools/math/Integer.hpp>
 
@@ -55,6 +56,8 @@ class TestIterators : public Test
         CPPUNIT_TEST_GATB (iterators_checkVariant1);
         CPPUNIT_TEST_GATB (iterators_checkVariant2);
         CPPUNIT_TEST_GATB (iterators_adaptator);
+        CPPUNIT_TEST_GATB (iterators_dispatchRange);
+        CPPUNIT_TEST_GATB (iterators_dispatchSplit);
 
     CPPUNIT_TEST_SUITE_GATB_END();
 
@@ -360,6 +363,103 @@ public:
             CPPUNIT_ASSERT (itAdapt.item() == table[i].x);
         }
     }
+
+    /********************************************************************************/
+    struct RangeFunctor
+    {
+        vector<u_int32_t>& hits;  u_int64_t offset;
+        RangeFunctor (vector<u_int32_t>& hits, u_int64_t offset) : hits(hits), offset(offset) {}
+        void operator() (u_int64_t idx)  {  __sync_fetch_and_add (&hits[idx-offset], 1);  }
+    };
+
+    struct SumFunctor
+    {
+        u_int64_t& sum;
+        SumFunctor (u_int64_t& sum) : sum(sum) {}
+        void operator() (int& i)  {  __sync_fetch_and_add (&sum, i);  }
+    };
+
+    /** \brief check the sharded iteration of a range of indexes by a dispatcher.
+     */
+    void iterators_dispatchRange ()
+    {
+        size_t nbCoresList[] = { 1, 2, 3, 8 };
+        size_t groupSizes[]  = { 1, 7, 1000 };
+
+        for (size_t c=0; c<sizeof(nbCoresList)/sizeof(nbCoresList[0]); c++)
+        {
+            Dispatcher dispatcher (nbCoresList[c]);
+
+            for (size_t g=0; g<sizeof(groupSizes)/sizeof(groupSizes[0]); g++)
+            {
+                /** Each index of the range must be iterated exactly once. */
+                vector<u_int32_t> hits (100000, 0);
+                dispatcher.iterateRange (10, 10+hits.size(), RangeFunctor (hits, 10), groupSizes[g]);
+
+                for (size_t i=0; i<hits.size(); i++)  {  CPPUNIT_ASSERT (hits[i] == 1);  }
+            }
+
+            /** An empty range. */
+            vector<u_int32_t> hits (1, 0);
+            dispatcher.iterateRange (5, 5, RangeFunctor (hits, 5));
+            CPPUNIT_ASSERT (hits[0] == 0);
+
+            /** Iteration of a vector. */
+            vector<int> values (12345);
+            for (size_t i=0; i<values.size(); i++)  { values[i] = i; }
+
+            u_int64_t sum = 0;
+            dispatcher.iterate (values, SumFunctor (sum));
+            CPPUNIT_ASSERT (sum == (u_int64_t)values.size()*(values.size()-1)/2);
+        }
+    }
+
+    /********************************************************************************/
+    struct CountListener : public IteratorListener
+    {
+        u_int64_t& nb;  size_t& nbInit;  size_t& nbFinish;
+        CountListener (u_int64_t& nb, size_t& nbInit, size_t& nbFinish) : nb(nb), nbInit(nbInit), nbFinish(nbFinish) {}
+        void init   ()                      { nbInit++;   }
+        void finish ()                      { nbFinish++; }
+        void inc    (u_int64_t ntasks_done) { nb += ntasks_done; }
+    };
+
+    /** \brief check the iteration of a composite iterator by a dispatcher, one part per thread.
+     */
+    void iterators_dispatchSplit ()
+    {
+        /** We create several lists of values. */
+        vector<list<int> > lists (17);
+        u_int64_t checksum = 0,  nbItems = 0;
+        for (size_t i=0; i<lists.size(); i++)
+        {
+            for (size_t j=0; j<i*100; j++)  {  lists[i].push_back (i*j);  checksum += i*j;  nbItems++;  }
+        }
+
+        for (size_t nbCores=1; nbCores<=4; nbCores++)
+        {
+            vector<Iterator<int>*> iterators;
+            for (size_t i=0; i<lists.size(); i++)  {  iterators.push_back (new ListIterator<int> (lists[i]));  }
+
+            u_int64_t nb = 0;  size_t nbInit = 0, nbFinish = 0;
+
+            /** We iterate the parts of a composite iterator, with some progress listener. */
+            SubjectIterator<int>* it = new SubjectIterator<int> (new CompositeIterator<int> (iterators), 10, new CountListener (nb, nbInit, nbFinish));
+
+            u_int64_t sum = 0;
+            Dispatcher(nbCores).iterateSplit (it, SumFunctor (sum), 10);
+
+            CPPUNIT_ASSERT (sum      == checksum);
+            CPPUNIT_ASSERT (nb       == nbItems);
+            CPPUNIT_ASSERT (nbInit   == 1);
+            CPPUNIT_ASSERT (nbFinish == 1);
+        }
+
+        /** A non composite iterator is iterated as usual. */
+        u_int64_t sum = 0;
+        Dispatcher(4).iterateSplit (new ListIterator<int> (lists[5]), SumFunctor (sum));
+        CPPUNIT_ASSERT (sum == 5*(500*499/2));
+    }
 };
 
 /********************************************************************************/
@@ -38,6 +38,7 @@ class TestMath : public Test
         CPPUNIT_TEST_GATB (math_checkBasic);
         CPPUNIT_TEST_GATB (math_checkFibo);
         CPPUNIT_TEST_GATB (math_test1);
+        CPPUNIT_TEST_GATB (math_checkKmerOps);
 
     CPPUNIT_TEST_SUITE_GATB_END();
 
@@ -172,6 +173,68 @@ public:
         math_test1_template <LargeInt<4> >();
         math_test1_template <LargeInt<5> >();
     }
+
+    /********************************************************************************/
+    /** We check the kmer operations (shift, add, revcomp, comparison, hashes) against
+     * references computed on the nucleotides string or on each 64 bits word. */
+    template <typename T> void math_checkKmerOpsTemplate (size_t precision)
+    {
+        const char nt[4]   = {'A','C','T','G'};
+        const char comp[4] = {'T','G','A','C'};  // complement of A,C,T,G
+
+        srand (17);
+
+        for (size_t k=1; k<=32*precision; k += (k<30 ? 7 : 13))
+        {
+            for (size_t n=0; n<50; n++)
+            {
+                string s1, s2, rc;
+                T x1, x2;  x1.setVal(0);  x2.setVal(0);
+
+                for (size_t i=0; i<k; i++)
+                {
+                    int c1 = rand() % 4;
+                    int c2 = i<k/2 ? c1 : rand() % 4;
+
+                    s1 += nt[c1];  x1 = (x1 << 2) + c1;
+                    s2 += nt[c2];  x2 = (x2 << 2) + c2;
+                    rc  = comp[c1] + rc;
+                }
+
+                CPPUNIT_ASSERT (x1.toString(k) == s1);
+                CPPUNIT_ASSERT (revcomp(x1,k).toString(k) == rc);
+                CPPUNIT_ASSERT (revcomp(revcomp(x1,k),k) == x1);
+
+                /** The order of the binary encoding is A<C<T<G. */
+                string o1 = s1, o2 = s2;
+                std::replace (o1.begin(), o1.end(), 'G', 'Z');  std::replace (o2.begin(), o2.end(), 'G', 'Z');
+
+                CPPUNIT_ASSERT ((x1 <  x2) == (o1 <  o2));
+                CPPUNIT_ASSERT ((x1 <= x2) == (o1 <= o2));
+                CPPUNIT_ASSERT ((x1 == x2) == (s1 == s2));
+                CPPUNIT_ASSERT ((x1 != x2) == (s1 != s2));
+                CPPUNIT_ASSERT (x1 <= x1 && !(x1 < x1));
+
+                u_int64_t h1 = 0, h2 = 0;
+                for (size_t i=0; i<precision; i++)
+                {
+                    u_int64_t word = (x1 >> (64*i)).getVal();
+                    h1 ^= NativeInt64::hash64   (word, 7);
+                    h2 ^= NativeInt64::oahash64 (word);
+                }
+                CPPUNIT_ASSERT (hash1  (x1, 7) == h1);
+                CPPUNIT_ASSERT (oahash (x1)    == h2);
+                CPPUNIT_ASSERT (simplehash16 (x1, 5) == NativeInt64::simplehash16_64 (x1.getVal(), 5));
+            }
+        }
+    }
+
+    void math_checkKmerOps ()
+    {
+        math_checkKmerOpsTemplate <LargeInt<2> >(2);
+        math_checkKmerOpsTemplate <LargeInt<3> >(3);
+        math_checkKmerOpsTemplate <LargeInt<4> >(4);
+    }
 };
 
 /********************************************************************************/
@@ -701,11 +701,31 @@ we need this 2-functors scheme because HashFunctors won't work with unordered_ma
 		int level;
 	};
 
+	// several ranges of keys that can be read independently, for instance the partitions of a set of keys:
+	// each range is read by a single thread at a time, so the threads don't share an iterator
+	template <typename Range>
+	struct multi_range
+	{
+		explicit multi_range(std::vector<Range> const& r) : ranges(r) {}
+		std::vector<Range> const& ranges;
+	};
+
+	template<typename Range>
+	struct thread_ranges_args
+	{
+		void * boophf;
+		std::vector<Range> const * ranges;
+		int level;
+	};
+
 	//forward declaration
 
     template <typename elem_t, typename Hasher_t, typename Range, typename it_type>
 	void * thread_processLevel(void * args);
 
+    template <typename elem_t, typename Hasher_t, typename Range>
+	void * thread_processLevelRanges(void * args);
+
 
     /* Hasher_t returns a single hash when operator()(elem_t key) is called.
        if used with XorshiftHashFunctors, it must have the following operator: operator()(elem_t key, uint64_t seed) */
@@ -734,52 +754,18 @@ we need this 2-functors scheme because HashFunctors won't work with unordered_ma
 		_gamma(gamma), _hash_domain(size_t(ceil(double(n) * gamma))), _nelem(n), _num_thread(num_thread), _percent_elem_loaded_for_fastMode (perc_elem_loaded), _withprogress(progress)
 		{
 			if(n ==0) return;
-			
-			_fastmode = false;
-			
-			if(_percent_elem_loaded_for_fastMode > 0.0 )
-				_fastmode =true;
-
-			setup();
-
-			if(_withprogress)
-			{
-			_progressBar.timer_mode=1;
-
-			if(_fastmode)
-				_progressBar.init( _nelem * (_fastModeLevel+1) +  ( _nelem * pow(_proba_collision,_fastModeLevel)) * (_nb_levels-(_fastModeLevel+1))    ,"Building BooPHF",num_thread);
-			else
-				_progressBar.init( _nelem * _nb_levels ,"Building BooPHF",num_thread);
-			}
-
-			uint64_t offset = 0;
-			for(int ii = 0; ii< _nb_levels; ii++)
-			{
-				_tempBitset =  new bitVector(_levels[ii].hash_domain); // temp collision bitarray for this level
-
-				processLevel(input_range,ii);
-
-				_levels[ii].bitset.clearCollisions(0 , _levels[ii].hash_domain , _tempBitset);
-
-				offset = _levels[ii].bitset.build_ranks(offset);
-
-				delete _tempBitset;
-			}
-
-			if(_withprogress)
-			_progressBar.finish_threaded();
-
-
-			_lastbitsetrank = offset ;
-
-			//printf("used temp ram for construction : %lli MB \n",setLevelFastmode.capacity()* sizeof(elem_t) /1024ULL/1024ULL);
 
-			std::vector<elem_t>().swap(setLevelFastmode);   // clear setLevelFastmode reallocating
+			build(input_range);
+		}
 
+		// same as above, but the keys are read concurrently from several ranges (one thread per range at a time)
+		template <typename Range>
+		mphf( size_t n, multi_range<Range> const& input_ranges,int num_thread = 1,  double gamma = 2.0 , bool progress =true, float perc_elem_loaded = 0.03) :
+		_gamma(gamma), _hash_domain(size_t(ceil(double(n) * gamma))), _nelem(n), _num_thread(num_thread), _percent_elem_loaded_for_fastMode (perc_elem_loaded), _withprogress(progress)
+		{
+			if(n ==0) return;
 
-			pthread_mutex_destroy(&_mutex);
-			
-			_built = true;
+			build(input_ranges);
 		}
 
 
@@ -869,54 +855,7 @@ we need this 2-functors scheme because HashFunctors won't work with unordered_ma
 				//do work on the n elems of the buffer
                 for(uint64_t ii=0; ii<inbuff ; ii++)
 				{
-					elem_t val = buffer[ii];
-
-					//auto hashes = _hasher(val);
-					hash_pair_t bbhash;  int level;
-					uint64_t level_hash = getLevel(bbhash,val,&level, i);
-
-					if(level == i) //insert into lvl i
-					{
-						//	__sync_fetch_and_add(& _cptLevel,1);
-
-						if(_fastmode && i == _fastModeLevel)
-						{
-
-							uint64_t idxl2 = __sync_fetch_and_add(& _idxLevelsetLevelFastmode,1);
-							//si depasse taille attendue pour setLevelFastmode, fall back sur slow mode mais devrait pas arriver si hash ok et proba avec nous
-							if(idxl2>= setLevelFastmode.size())
-								_fastmode = false;
-							else
-								setLevelFastmode[idxl2] = val; // create set for fast mode
-						}
-
-						//insert to level i+1 : either next level of the cascade or final hash if last level reached
-						if(i == _nb_levels-1) //stop cascade here, insert into exact hash
-						{
-
-							uint64_t hashidx =  __sync_fetch_and_add (& _hashidx, 1);
-
-							pthread_mutex_lock(&_mutex); //see later if possible to avoid this, mais pas bcp item vont la
-							// calc rank de fin  precedent level qq part, puis init hashidx avec ce rank, direct minimal, pas besoin inser ds bitset et rank
-							_final_hash[val] = hashidx;
-							pthread_mutex_unlock(&_mutex);
-						}
-						else
-						{
-
-							//computes next hash
-
-							if ( level == 0)
-								level_hash = _hasher.h0(bbhash,val);
-							else if ( level == 1)
-								level_hash = _hasher.h1(bbhash,val);
-							else
-							{
-								level_hash = _hasher.next(bbhash);
-							}
-							insertIntoLevel(level_hash,i); //should be safe
-						}
-					}
+					processElem(buffer[ii], i);
 
 					nb_done++;
 					if((nb_done&1023) ==0  && _withprogress) {_progressBar.inc(nb_done,tid);nb_done=0; }
@@ -928,6 +867,26 @@ we need this 2-functors scheme because HashFunctors won't work with unordered_ma
 
 		}
 
+		// each thread takes the next range not read yet and reads it on its own, without lock
+		template <typename Range>
+        void pthread_processLevelRanges(std::vector<Range> const& ranges, int i)
+		{
+			uint64_t nb_done =0;
+			int tid =  __sync_fetch_and_add (&_nb_living, 1);
+
+			for (uint64_t r = __sync_fetch_and_add (&_idxRange, 1);  r < ranges.size();  r = __sync_fetch_and_add (&_idxRange, 1))
+			{
+				auto until = ranges[r].end();
+				for (auto it = ranges[r].begin(); it != until; ++it)
+				{
+					processElem(*it, i);
+
+					nb_done++;
+					if((nb_done&1023) ==0  && _withprogress) {_progressBar.inc(nb_done,tid);nb_done=0; }
+				}
+			}
+		}
+
 
 		void save(std::ostream& os) const
 		{
@@ -1012,6 +971,108 @@ we need this 2-functors scheme because HashFunctors won't work with unordered_ma
 
 		private :
 
+		//build the cascade of levels from the input keys
+		template <typename Range>
+		void build(Range const& input_range)
+		{
+			_fastmode = false;
+
+			if(_percent_elem_loaded_for_fastMode > 0.0 )
+				_fastmode =true;
+
+			setup();
+
+			if(_withprogress)
+			{
+			_progressBar.timer_mode=1;
+
+			if(_fastmode)
+				_progressBar.init( _nelem * (_fastModeLevel+1) +  ( _nelem * pow(_proba_collision,_fastModeLevel)) * (_nb_levels-(_fastModeLevel+1))    ,"Building BooPHF",_num_thread);
+			else
+				_progressBar.init( _nelem * _nb_levels ,"Building BooPHF",_num_thread);
+			}
+
+			uint64_t offset = 0;
+			for(int ii = 0; ii< _nb_levels; ii++)
+			{
+				_tempBitset =  new bitVector(_levels[ii].hash_domain); // temp collision bitarray for this level
+
+				processLevel(input_range,ii);
+
+				_levels[ii].bitset.clearCollisions(0 , _levels[ii].hash_domain , _tempBitset);
+
+				offset = _levels[ii].bitset.build_ranks(offset);
+
+				delete _tempBitset;
+			}
+
+			if(_withprogress)
+			_progressBar.finish_threaded();
+
+
+			_lastbitsetrank = offset ;
+
+			//printf("used temp ram for construction : %lli MB \n",setLevelFastmode.capacity()* sizeof(elem_t) /1024ULL/1024ULL);
+
+			std::vector<elem_t>().swap(setLevelFastmode);   // clear setLevelFastmode reallocating
+
+
+			pthread_mutex_destroy(&_mutex);
+
+			_built = true;
+		}
+
+		//insert one element into level i, or into the final hash if i is the last level
+		void processElem(elem_t const& val, int i)
+		{
+			//auto hashes = _hasher(val);
+			hash_pair_t bbhash;  int level;
+			uint64_t level_hash = getLevel(bbhash,val,&level, i);
+
+			if(level == i) //insert into lvl i
+			{
+				//	__sync_fetch_and_add(& _cptLevel,1);
+
+				if(_fastmode && i == _fastModeLevel)
+				{
+
+					uint64_t idxl2 = __sync_fetch_and_add(& _idxLevelsetLevelFastmode,1);
+					//si depasse taille attendue pour setLevelFastmode, fall back sur slow mode mais devrait pas arriver si hash ok et proba avec nous
+					if(idxl2>= setLevelFastmode.size())
+						_fastmode = false;
+					else
+						setLevelFastmode[idxl2] = val; // create set for fast mode
+				}
+
+				//insert to level i+1 : either next level of the cascade or final hash if last level reached
+				if(i == _nb_levels-1) //stop cascade here, insert into exact hash
+				{
+
+					uint64_t hashidx =  __sync_fetch_and_add (& _hashidx, 1);
+
+					pthread_mutex_lock(&_mutex); //see later if possible to avoid this, mais pas bcp item vont la
+					// calc rank de fin  precedent level qq part, puis init hashidx avec ce rank, direct minimal, pas besoin inser ds bitset et rank
+					_final_hash[val] = hashidx;
+					pthread_mutex_unlock(&_mutex);
+				}
+				else
+				{
+
+					//computes next hash
+
+					if ( level == 0)
+						level_hash = _hasher.h0(bbhash,val);
+					else if ( level == 1)
+						level_hash = _hasher.h1(bbhash,val);
+					else
+					{
+						level_hash = _hasher.next(bbhash);
+					}
+					insertIntoLevel(level_hash,i); //should be safe
+				}
+			}
+		}
+
 		void setup()
 		{
 			pthread_mutex_init(&_mutex, NULL);
@@ -1160,6 +1221,47 @@ we need this 2-functors scheme because HashFunctors won't work with unordered_ma
 			delete [] tab_threads;
 		}
 
+		//loop to insert into level i, the threads reading the ranges concurrently
+		template <typename Range>
+		void processLevel(multi_range<Range> const& input_ranges,int i)
+		{
+			//the levels read from the in-memory set of fast mode don't need the ranges anymore
+			if(_fastmode && i >= (_fastModeLevel+1) && !input_ranges.ranges.empty())
+			{
+				processLevel(input_ranges.ranges[0], i);
+				return;
+			}
+
+			////alloc the bitset for this level
+			_levels[i].bitset =  bitVector(_levels[i].hash_domain); ;
+
+			_cptLevel = 0;
+			_hashidx = 0;
+			_idxLevelsetLevelFastmode =0;
+			_nb_living =0;
+			_idxRange =0;
+			//create  threads
+			pthread_t *tab_threads= new pthread_t [_num_thread];
+			thread_ranges_args<Range> t_arg; // meme arg pour tous
+			t_arg.boophf = this;
+			t_arg.ranges = &input_ranges.ranges;
+			t_arg.level = i;
+
+			for(int ii=0;ii<_num_thread;ii++)
+				pthread_create (&tab_threads[ii], NULL,  thread_processLevelRanges<elem_t, Hasher_t, Range>, &t_arg);
+			//joining
+			for(int ii=0;ii<_num_thread;ii++)
+			{
+				pthread_join(tab_threads[ii], NULL);
+			}
+
+			if(_fastmode && i == _fastModeLevel) //shrink to actual number of elements in set
+			{
+				setLevelFastmode.resize(_idxLevelsetLevelFastmode);
+			}
+			delete [] tab_threads;
+		}
+
 	private:
 		//level ** _levels;
 		std::vector<level> _levels;
@@ -1178,6 +1280,7 @@ we need this 2-functors scheme because HashFunctors won't work with unordered_ma
 		double _proba_collision;
 		uint64_t _lastbitsetrank;
 		uint64_t _idxLevelsetLevelFastmode;
+		uint64_t _idxRange;
 		uint64_t _cptLevel;
 
 		// fast build mode , requires  that _percent_elem_loaded_for_fastMode %   elems are loaded in ram
@@ -1218,6 +1321,20 @@ we need this 2-functors scheme because HashFunctors won't work with unordered_ma
 
 		obw->pthread_processLevel(buffer, startit, until_p, level);
 
+		return NULL;
+	}
+
+    template <typename elem_t, typename Hasher_t, typename Range>
+	void * thread_processLevelRanges(void * args)
+	{
+		if(args ==NULL) return NULL;
+
+		thread_ranges_args<Range> *targ = (thread_ranges_args<Range>*) args;
+
+		mphf<elem_t, Hasher_t>  * obw = (mphf<elem_t, Hasher_t > *) targ->boophf;
+
+		obw->pthread_processLevelRanges(*targ->ranges, targ->level);
+
 		return NULL;
 	}
 }